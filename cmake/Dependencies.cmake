@@ -16,17 +16,9 @@ FetchContent_Declare(
     GIT_TAG        v1.15.3
     EXCLUDE_FROM_ALL
 )
-# YAML-CPP
-FetchContent_Declare(
-    yamlcpp
-    GIT_REPOSITORY https://github.com/jbeder/yaml-cpp.git
-    GIT_TAG        0.8.0
-    EXCLUDE_FROM_ALL
-)
 
 # This will now respect EXCLUDE_FROM_ALL thanks to the FETCHCONTENT_TRY_EXCLUDE_FROM_ALL_* vars
 FetchContent_MakeAvailable(
     safetyhook
     spdlog
-    yamlcpp
 )
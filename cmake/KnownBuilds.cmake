@@ -0,0 +1,125 @@
+# MIT License
+#
+# Copyright (c) 2025 Dominik Protasewicz
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Generates a constexpr table of known-good signature RVAs from a CSV file.
+#
+# generate_known_builds(<csv> <output> <valid exes...>)
+#   <csv>         Input file, see cmake/KnownBuilds.csv for the format.
+#   <output>      Header to generate.
+#   <valid exes>  Exe names an entry is allowed to refer to.
+function(generate_known_builds CSV OUTPUT)
+    set(VALID_EXES ${ARGN})
+    set(HEX "^(0x)?[0-9A-Fa-f]+$")
+
+    file(STRINGS "${CSV}" LINES)
+    set(KNOWN_BUILDS_COUNT 0)
+    set(KNOWN_BUILDS_ENTRIES "")
+    foreach(LINE ${LINES})
+        string(STRIP "${LINE}" LINE)
+        if(LINE STREQUAL "" OR LINE MATCHES "^#")
+            continue()
+        endif()
+
+        string(REPLACE "," ";" FIELDS "${LINE}")
+        list(LENGTH FIELDS FIELD_COUNT)
+        if(NOT FIELD_COUNT EQUAL 5)
+            message(FATAL_ERROR "${CSV}: expected 5 fields but got ${FIELD_COUNT}: '${LINE}'")
+        endif()
+        list(GET FIELDS 0 EXE)
+        list(GET FIELDS 1 TIME_DATE_STAMP)
+        list(GET FIELDS 2 CHECK_SUM)
+        list(GET FIELDS 3 RVA)
+        list(GET FIELDS 4 SIGNATURE)
+        string(STRIP "${SIGNATURE}" SIGNATURE)
+
+        if(NOT EXE IN_LIST VALID_EXES)
+            message(FATAL_ERROR "${CSV}: '${EXE}' is not one of the valid game exe's: ${VALID_EXES}")
+        endif()
+        foreach(VALUE ${TIME_DATE_STAMP} ${CHECK_SUM} ${RVA})
+            if(NOT VALUE MATCHES "${HEX}")
+                message(FATAL_ERROR "${CSV}: '${VALUE}' is not a hex number: '${LINE}'")
+            endif()
+        endforeach()
+        if(NOT SIGNATURE MATCHES "^[0-9A-Fa-f? ]+$")
+            message(FATAL_ERROR "${CSV}: '${SIGNATURE}' is not an IDA-style signature")
+        endif()
+
+        string(REGEX REPLACE "^0x" "" TIME_DATE_STAMP "${TIME_DATE_STAMP}")
+        string(REGEX REPLACE "^0x" "" CHECK_SUM "${CHECK_SUM}")
+        string(REGEX REPLACE "^0x" "" RVA "${RVA}")
+        string(APPEND KNOWN_BUILDS_ENTRIES
+            "        { \"${EXE}\", 0x${TIME_DATE_STAMP}, 0x${CHECK_SUM}, 0x${RVA}, \"${SIGNATURE}\" },\n"
+        )
+        math(EXPR KNOWN_BUILDS_COUNT "${KNOWN_BUILDS_COUNT} + 1")
+    endforeach()
+    string(REGEX REPLACE "\n$" "" KNOWN_BUILDS_ENTRIES "${KNOWN_BUILDS_ENTRIES}")
+
+    configure_file("${CMAKE_CURRENT_FUNCTION_LIST_DIR}/known_builds.hpp.in" "${OUTPUT}" @ONLY)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${CSV}")
+    message(STATUS "Known builds: ${KNOWN_BUILDS_COUNT} entries from '${CSV}'")
+endfunction()
+
+# Reads a little-endian u32 from a file as a hex string without the 0x prefix.
+function(read_u32 FILE OFFSET OUT)
+    file(READ "${FILE}" BYTES OFFSET ${OFFSET} LIMIT 4 HEX)
+    string(REGEX REPLACE "^(..)(..)(..)(..)$" "\\4\\3\\2\\1" VALUE "${BYTES}")
+    string(TOUPPER "${VALUE}" VALUE)
+    set(${OUT} "${VALUE}" PARENT_SCOPE)
+endfunction()
+
+# Reports whether the build of a game exe is listed in the known builds table.
+#
+# check_known_build(<exe path> <csv>)
+function(check_known_build EXE_PATH CSV)
+    # e_lfanew -> IMAGE_NT_HEADERS, TimeDateStamp at +8 and OptionalHeader.CheckSum at +88
+    read_u32("${EXE_PATH}" 60 E_LFANEW)
+    math(EXPR TIME_DATE_STAMP_OFFSET "0x${E_LFANEW} + 8")
+    math(EXPR CHECK_SUM_OFFSET "0x${E_LFANEW} + 88")
+    read_u32("${EXE_PATH}" ${TIME_DATE_STAMP_OFFSET} TIME_DATE_STAMP)
+    read_u32("${EXE_PATH}" ${CHECK_SUM_OFFSET} CHECK_SUM)
+
+    get_filename_component(EXE "${EXE_PATH}" NAME)
+    math(EXPR TIME_DATE_STAMP "0x${TIME_DATE_STAMP}" OUTPUT_FORMAT HEXADECIMAL)
+    math(EXPR CHECK_SUM "0x${CHECK_SUM}" OUTPUT_FORMAT HEXADECIMAL)
+
+    set(KNOWN false)
+    file(STRINGS "${CSV}" LINES REGEX "^${EXE},")
+    foreach(LINE ${LINES})
+        string(REPLACE "," ";" FIELDS "${LINE}")
+        list(GET FIELDS 1 ENTRY_TIME_DATE_STAMP)
+        list(GET FIELDS 2 ENTRY_CHECK_SUM)
+        string(REGEX REPLACE "^0x" "" ENTRY_TIME_DATE_STAMP "${ENTRY_TIME_DATE_STAMP}")
+        string(REGEX REPLACE "^0x" "" ENTRY_CHECK_SUM "${ENTRY_CHECK_SUM}")
+        math(EXPR ENTRY_TIME_DATE_STAMP "0x${ENTRY_TIME_DATE_STAMP}" OUTPUT_FORMAT HEXADECIMAL)
+        math(EXPR ENTRY_CHECK_SUM "0x${ENTRY_CHECK_SUM}" OUTPUT_FORMAT HEXADECIMAL)
+        if(ENTRY_TIME_DATE_STAMP STREQUAL TIME_DATE_STAMP AND ENTRY_CHECK_SUM STREQUAL CHECK_SUM)
+            set(KNOWN true)
+        endif()
+    endforeach()
+
+    if(KNOWN)
+        message(STATUS "'${EXE}' build ${TIME_DATE_STAMP}/${CHECK_SUM} is a known build")
+    else()
+        message(STATUS
+            "'${EXE}' build ${TIME_DATE_STAMP}/${CHECK_SUM} is not in known builds, signatures will be scanned for")
+    endif()
+endfunction()
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Utils
+{
+#ifdef HOOK_ALLOC_AUDIT
+    constexpr bool allocAuditEnabled = true;
+#else
+    constexpr bool allocAuditEnabled = false;
+#endif
+
+    /**
+     * @brief Opt-in counters of the heap allocations made inside the hooks.
+     * @details Compiled in with the CMake option `HOOK_ALLOC_AUDIT`, otherwise every function
+     *      here is an empty inline and costs nothing.
+     *
+     *      The mod's global `operator new` and `operator delete` are replaced by ones that count
+     *      each allocation made by a thread while it is inside an `AllocScope`. Everything the
+     *      mod allocates through the standard library goes through them, the game and the
+     *      system libraries have their own heaps and are not counted. Nested scopes charge an
+     *      allocation to the innermost one only.
+     *
+     *      Nothing is counted until `start`, which is called once startup is done, from then on
+     *      any allocation is a bug in a path that runs every frame or every read. A thread
+     *      reports each hook's calls, the calls that allocated, and the allocations per thread
+     *      whenever they grew since the previous report.
+     *
+     *      With `HOOK_STATS` compiled in as well, a thread's first timed hit allocates its stats
+     *      block and shows up here once.
+     */
+    class AllocAudit {
+    public:
+        static constexpr size_t maxHooks = 16;
+        static constexpr size_t maxThreads = 64;
+
+#ifdef HOOK_ALLOC_AUDIT
+        /**
+         * @brief Registers a hook, call before the hook is installed.
+         *
+         * @param name Name the hook is reported under.
+         * @return std::uint32_t Id to scope with. The last id is reserved, every hook past the
+         *      first `maxHooks - 1` shares it and is reported as "other".
+         */
+        static std::uint32_t add(const std::string& name);
+
+        /**
+         * @brief Enters a scope on the calling thread.
+         *
+         * @return std::uint32_t Allocations of the enclosing scope so far, to pass to `leave`.
+         */
+        static std::uint32_t enter();
+
+        /**
+         * @brief Leaves a scope on the calling thread and records what it allocated.
+         *
+         * @param id Id from `add`.
+         * @param outer Value returned by the matching `enter`.
+         */
+        static void leave(std::uint32_t id, std::uint32_t outer);
+
+        /**
+         * @brief Counts one allocation if the calling thread is inside a scope.
+         */
+        static void count();
+
+        /**
+         * @brief Starts counting and reporting every `intervalMs`.
+         *
+         * @param intervalMs Milliseconds between reports.
+         */
+        static void start(std::uint32_t intervalMs);
+#else
+        static std::uint32_t add(const std::string&) { return 0; }
+        static void start(std::uint32_t) {}
+#endif
+    };
+
+    /**
+     * @brief Counts the allocations made in the scope it lives in as one call of a hook.
+     */
+    class AllocScope {
+    public:
+#ifdef HOOK_ALLOC_AUDIT
+        explicit AllocScope(std::uint32_t id) : id(id), outer(AllocAudit::enter()) {}
+        ~AllocScope() { AllocAudit::leave(id, outer); }
+
+    private:
+        std::uint32_t id;
+        std::uint32_t outer;
+#else
+        explicit AllocScope(std::uint32_t) {}
+#endif
+    };
+}
@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <windows.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Serves synchronous reads of the `.qpck` archives from read-only mapped views.
+     * @details The game streams everything out of its archives with many small synchronous
+     *      `ReadFile` calls. Copying out of a mapped view of the archive skips the I/O request
+     *      per read and lets the memory manager read ahead in large clusters instead.
+     *
+     *      The process is 32-bit and the archives add up to gigabytes, so an archive is never
+     *      mapped whole. Reads are copied from a fixed pool of `windowCount` views of
+     *      `windowSize` bytes shared by all archives, the least recently used view is replaced
+     *      when a read falls outside all of them. Up to `maxArchives` archives are tracked in a
+     *      fixed table, so serving a read never allocates.
+     *
+     *      `read` behaves like `ReadFile` on a synchronous handle: it starts at the handle's file
+     *      pointer, stops at the end of the file and moves the pointer past what it copied. It
+     *      never blocks on another reader, anything it can not serve right away, a read larger
+     *      than a view, a mapping or view that can not be created or a fault while copying, is
+     *      left to the kernel with nothing changed.
+     */
+    class ArchiveReader {
+    public:
+        static constexpr size_t windowSize = 16 * 1024 * 1024;
+        static constexpr size_t windowCount = 8;
+        static constexpr size_t maxArchives = 64;
+
+        /**
+         * @brief Serves a synchronous read of an archive.
+         *
+         * @param file Handle to the archive, opened for synchronous reads.
+         * @param buffer Buffer the data is copied to.
+         * @param size Number of bytes to read.
+         * @param read Receives the number of bytes read.
+         * @return true if the read was served, false if `ReadFile` has to do it.
+         */
+        bool read(HANDLE file, void* buffer, DWORD size, DWORD* read);
+
+        /**
+         * @brief Releases the mapping and views of an archive, call when its handle is closed.
+         * @details Call it for every handle that is closed, not only the ones known to be archives.
+         *      Handle values are reused, an entry that outlives its file would serve the next file
+         *      opened with the same value. Handles that are not archives are ignored.
+         */
+        void close(HANDLE file);
+
+    private:
+        struct Archive {
+            HANDLE file;
+            HANDLE mapping;
+            u64 size;
+        };
+
+        struct Window {
+            HANDLE file;
+            u64 index;
+            const u8* view;
+            u64 lastUse;
+        };
+
+        /**
+         * Entry of an archive, nullptr finds a free one.
+         */
+        Archive* find(HANDLE file);
+        const u8* window(HANDLE file, const Archive& archive, u64 index);
+
+        std::mutex mutex;
+        std::array<Archive, maxArchives> archives{};
+        std::array<Window, windowCount> windows{};
+        u64 uses = 0;
+    };
+}
@@ -0,0 +1,233 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <windows.h>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "utils.hpp"
+#include "hooktransaction.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief A small hand written detour for hooks that only override a value.
+     * @details A `SafetyHookMid` saves and restores every register and calls into C++ each
+     *      time it runs, which is a lot of work for a hook that only loads a constant into a
+     *      register every frame. A code cave instead runs a few instructions emitted here,
+     *      followed by the instructions displaced from the hook site and a jump back.
+     *
+     *      Code is emitted with the helpers below and runs before the displaced instructions.
+     *      Memory operands are absolute addresses, the values they point to must outlive the
+     *      cave, which is never removed.
+     *
+     *      Displaced instructions are decoded with Zydis. `call rel32` and `jmp rel32` are
+     *      re-encoded for their new address, any other relative instruction makes `install`
+     *      fail and leaves the site untouched.
+     */
+    class CodeCave {
+    public:
+        /**
+         * @brief General purpose registers, in encoding order.
+         */
+        enum class Reg : u8 {
+            eax = 0,
+            ecx,
+            edx,
+            ebx,
+            esp,
+            ebp,
+            esi,
+            edi,
+        };
+
+        /**
+         * @brief Emits `movss xmm0, dword ptr [source]`.
+         * @note The load form of movss zeroes the upper three lanes of xmm0.
+         */
+        void movssXmm0(const void* source);
+
+        /**
+         * @brief Emits `movss xmm0, dword ptr [base + disp]`, `base` can not be esp.
+         * @note The load form of movss zeroes the upper three lanes of xmm0.
+         */
+        void movssXmm0(Reg base, i8 disp);
+
+        /**
+         * @brief Emits `cmp byte ptr [address], value`.
+         * @note Flags are not saved, only use this where the displaced code does not read them.
+         */
+        void cmpByte(const void* address, u8 value);
+
+        /**
+         * @brief Emits `cmp byte ptr [base + disp], value`, `base` can not be esp.
+         * @note Flags are not saved, only use this where the displaced code does not read them.
+         */
+        void cmpByte(Reg base, i8 disp, u8 value);
+
+        /**
+         * @brief Emits `lock inc dword ptr [address]`.
+         * @note Flags are not saved, only use this where the displaced code does not read them.
+         */
+        void lockInc(const void* address);
+
+        /**
+         * @brief Emits `pushfd`.
+         */
+        void pushfd();
+
+        /**
+         * @brief Emits `popfd`.
+         */
+        void popfd();
+
+        /**
+         * @brief Emits `push reg`.
+         */
+        void push(Reg reg);
+
+        /**
+         * @brief Emits `pop reg`.
+         */
+        void pop(Reg reg);
+
+        /**
+         * @brief Emits `mov dst, dword ptr [source]`.
+         */
+        void mov(Reg dst, const void* source);
+
+        /**
+         * @brief Emits `mov dst, dword ptr [base + disp]`, `base` can not be esp.
+         */
+        void mov(Reg dst, Reg base, i8 disp);
+
+        /**
+         * @brief Emits `mov dword ptr [base + disp], src`, `base` can not be esp.
+         */
+        void mov(Reg base, i8 disp, Reg src);
+
+        /**
+         * @brief Emits `and reg, value`.
+         */
+        void andImm(Reg reg, u32 value);
+
+        /**
+         * @brief Emits `cmp reg, value`.
+         */
+        void cmpImm(Reg reg, u32 value);
+
+        /**
+         * @brief Emits a short `jne` with its target still unknown, at most 127 bytes ahead.
+         *
+         * @return size_t Position of the jump, to be passed to `bind`.
+         */
+        size_t jne();
+
+        /**
+         * @brief Emits a short `je` with its target still unknown, at most 127 bytes ahead.
+         *
+         * @return size_t Position of the jump, to be passed to `bind`.
+         */
+        size_t je();
+
+        /**
+         * @brief Points a jump from `jne` or `je` at the code emitted next.
+         *
+         * @param jump Position returned by `jne` or `je`.
+         */
+        void bind(size_t jump);
+
+        /**
+         * @brief Emits raw bytes, for anything the helpers do not cover.
+         *
+         * @param bytes Position independent machine code.
+         */
+        void emit(std::span<const u8> bytes);
+
+        /**
+         * @brief Writes the cave to executable memory and detours the site to it.
+         * @details Enough whole instructions to fit a 5 byte `jmp rel32` are displaced from
+         *      `site` into the cave, the site is overwritten with the jump and padded with
+         *      NOPs. Other threads are frozen while the site is written, one stopped inside the
+         *      displaced instructions is moved to their copy in the cave. With a
+         *      `Utils::HookTransaction` open the site is only queued and written on its commit.
+         *
+         * @param site Address of the first instruction to displace.
+         * @param name Name of the hook, for the log.
+         * @return true if the detour was installed or queued.
+         */
+        bool install(uintptr_t site, const std::string& name = "CodeCave");
+
+    private:
+        std::vector<u8> code;
+
+        void emitAddress(const void* address);
+        void emitImm(u32 value);
+        void emitModRm(u8 mod, u8 reg, u8 rm);
+    };
+
+    /**
+     * @brief Injects a code cave based on a signature pattern match.
+     *
+     * @tparam Func The type of the function emitting the cave's code.
+     * @param enable If true, the cave will be injected; otherwise, it is skipped.
+     * @param module The module to scan for the signature.
+     * @param hook The signature pattern and offset information for the hook.
+     * @param build Called with the `CodeCave` to emit the code that runs before the displaced
+     *      instructions.
+     *
+     * @details The hook address comes from `Utils::resolveHook`. With `HOOK_STATS` compiled in
+     *      the cave first counts its hit, flags saved around the increment, and is reported
+     *      under `SignatureHook::name`.
+     *
+     * @see Utils::resolveSignatures
+     */
+    template <typename Func>
+    void injectCave(bool enable, Utils::ModuleInfo& module, Utils::SignatureHook& hook, Func&& build) {
+        if (enable) {
+            u64 hookAbsAddr = Utils::resolveHook(module, hook);
+            if (hookAbsAddr != 0) {
+                u64 hookRelAddr = hookAbsAddr - reinterpret_cast<u64>(module.address);
+                Utils::CodeCave cave;
+                if constexpr (Utils::hookStatsEnabled) {
+                    u32 statsId = Utils::HookStats::add(hook.name.empty() ? std::string(hook.signature.text) : hook.name);
+                    cave.pushfd();
+                    cave.lockInc(Utils::HookStats::caveCounter(statsId));
+                    cave.popfd();
+                }
+                build(cave);
+                if (cave.install(static_cast<uintptr_t>(hookAbsAddr), hook.name.empty() ? std::string(hook.signature.text) : hook.name)) {
+                    LOG("Cave {}@ {:s}+{:x}", Utils::HookTransaction::current() ? "queued " : "", module.name, hookRelAddr);
+                }
+                else {
+                    LOG("Failed to install cave @ {:s}+{:x}", module.name, hookRelAddr);
+                }
+            }
+        }
+    }
+}
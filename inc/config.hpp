@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Reader for the flat subset of YAML used by GodEater1-2Fix.yml.
+     * @details Supports nested maps by indentation, plain and quoted scalars and `#` comments,
+     *      which is all the mod's config uses. Values are stored as raw strings under their
+     *      dotted path, e.g. `features.constrainHud.enable`, and converted on lookup. Nothing
+     *      throws, a file that can not be read or parsed loads as empty so every lookup returns
+     *      its default.
+     */
+    class Config {
+    public:
+        /**
+         * @brief Reads and parses a config file, replacing anything loaded before.
+         *
+         * @param path Path to the .yml file.
+         * @return true if the file was read and parsed, otherwise the config is empty and
+         *      `error` says why.
+         */
+        bool load(const std::string& path);
+
+        /**
+         * @brief Why the last `load` failed.
+         */
+        const std::string& error() const;
+
+        /**
+         * @brief Looks up a boolean, `true`/`false`, `yes`/`no` or `on`/`off` in any case.
+         *
+         * @param key Dotted path of the value.
+         * @param fallback Returned if the key is missing or not a boolean.
+         */
+        bool getBool(const std::string& key, bool fallback) const;
+
+        /**
+         * @brief Looks up an unsigned 32 bit integer.
+         *
+         * @param key Dotted path of the value.
+         * @param fallback Returned if the key is missing or not an integer in range.
+         */
+        u32 getU32(const std::string& key, u32 fallback) const;
+
+        /**
+         * @brief Looks up a string, quotes are already removed.
+         *
+         * @param key Dotted path of the value.
+         * @param fallback Returned if the key is missing.
+         */
+        std::string getString(const std::string& key, const std::string& fallback) const;
+
+    private:
+        std::unordered_map<std::string, std::string> values;
+        std::string lastError;
+    };
+}
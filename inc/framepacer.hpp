@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <windows.h>
+#include <cstdint>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Holds the render thread to a target frame rate with even frame times.
+     * @details Each frame gets a deadline one period after the previous one, so a frame that ran
+     *      long is made up for by the next instead of pushing every following frame back. A frame
+     *      more than a whole period late starts the schedule over rather than rushing frames out
+     *      to catch up.
+     *
+     *      Most of the wait is slept on a high resolution waitable timer, available since
+     *      Windows 10 1803, and the last `spinHighResolution` are spun on the performance
+     *      counter. Older systems fall back to a regular waitable timer, which needs a much
+     *      longer spin of `spinLegacy` to hit the deadline.
+     *
+     *      Only meant to be called from one thread, the one presenting.
+     */
+    class FramePacer {
+    public:
+        static constexpr f64 spinHighResolution = 0.0005;
+        static constexpr f64 spinLegacy = 0.002;
+
+        FramePacer() = default;
+        ~FramePacer();
+
+        FramePacer(const FramePacer&) = delete;
+        FramePacer& operator=(const FramePacer&) = delete;
+
+        /**
+         * @brief Waits until the current frame's deadline.
+         *
+         * @param fps Target frame rate, 0 returns right away and resets the schedule.
+         */
+        void wait(u32 fps);
+
+    private:
+        void sleepUntil(i64 deadline);
+
+        HANDLE timer = nullptr;
+        bool timerCreated = false;
+        i64 spinTicks = 0;
+        i64 frequency = 0;
+        i64 period = 0;
+        i64 next = 0;
+        u32 fps = 0;
+    };
+
+    /**
+     * @brief Finds `IDXGISwapChain::Present` in dxgi.dll.
+     * @details Creates a throwaway device and swap chain on a hidden window and reads the
+     *      address out of the swap chain's vtable, which every swap chain in the process shares.
+     *
+     * @return void* Address of Present, nullptr if no device could be created.
+     */
+    void* findSwapChainPresent();
+}
@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <windows.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief What kind of file a handle refers to, as far as the fixes care.
+     *
+     * - **Unknown:** Not classified yet, only ever returned by `HandleCache::find`.
+     * - **Unnamed:** No path could be retrieved, e.g. pipes or consoles.
+     * - **Other:** Any file not listed below.
+     * - **Movie:** A `.wmv` movie streamed by DirectShow.
+     * - **Archive:** One of the game's `.qpck` archives.
+     */
+    enum class FileKind : u8 {
+        Unknown = 0,
+        Unnamed,
+        Other,
+        Movie,
+        Archive,
+    };
+
+    /**
+     * @brief Classifies the file behind a handle by its extension.
+     * @details Calls `GetFinalPathNameByHandleW` into a stack buffer and compares the
+     *      extension case-insensitively, nothing is allocated. This is the slow path and
+     *      meant to run once per handle, see `Utils::HandleCache`.
+     *
+     * @param file Handle to classify.
+     * @return FileKind of the handle, never `FileKind::Unknown`.
+     */
+    FileKind classifyFile(HANDLE file);
+
+    /**
+     * @brief Lock-free cache of handle classifications.
+     * @details Fixed-size open-addressing table with linear probing over a small window.
+     *      Any thread may call any member at any time, no locks are taken and nothing is
+     *      allocated. A slot holds key and kind in a single word updated with a CAS.
+     *
+     *      The table is a cache, not a source of truth. When the probe window is full an
+     *      insert is dropped and the handle is simply classified again on its next lookup.
+     *      `erase` clears every copy of a handle in its window so a reused handle value is
+     *      never served a stale classification.
+     */
+    class HandleCache {
+    public:
+        static constexpr size_t capacity = 4096;
+        static constexpr size_t probeWindow = 16;
+
+        /**
+         * @brief Looks up a handle.
+         * @return FileKind of the handle or `FileKind::Unknown` if it is not cached.
+         */
+        FileKind find(HANDLE handle) const {
+            u32 key = toKey(handle);
+            for (size_t i = 0, slot = home(key); i < probeWindow; ++i, slot = (slot + 1) & (capacity - 1)) {
+                u64 current = slots[slot].load(std::memory_order_acquire);
+                if (keyOf(current) == key) {
+                    return kindOf(current);
+                }
+                if (current == 0) {
+                    break;
+                }
+            }
+            return FileKind::Unknown;
+        }
+
+        /**
+         * @brief Caches the classification of a handle, best effort.
+         */
+        void insert(HANDLE handle, FileKind kind) {
+            u32 key = toKey(handle);
+            if (key == 0) {
+                return;
+            }
+            u64 value = pack(key, kind);
+            for (size_t i = 0, slot = home(key); i < probeWindow; ++i, slot = (slot + 1) & (capacity - 1)) {
+                u64 current = slots[slot].load(std::memory_order_acquire);
+                while (current == 0 || keyOf(current) == key) {
+                    if (slots[slot].compare_exchange_weak(current, value, std::memory_order_acq_rel)) {
+                        return;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Drops a handle from the cache, called when the handle is closed.
+         */
+        void erase(HANDLE handle) {
+            u32 key = toKey(handle);
+            if (key == 0) {
+                return;
+            }
+            for (size_t i = 0, slot = home(key); i < probeWindow; ++i, slot = (slot + 1) & (capacity - 1)) {
+                u64 current = slots[slot].load(std::memory_order_acquire);
+                while (current != 0 && keyOf(current) == key) {
+                    if (slots[slot].compare_exchange_weak(current, 0, std::memory_order_acq_rel)) {
+                        break;
+                    }
+                }
+            }
+        }
+
+    private:
+        // Key and kind share one word so a slot can never be seen half written. Handles only
+        // have 32 significant bits, even in 64-bit processes.
+        using Slot = std::atomic<u64>;
+
+        static u32 toKey(HANDLE handle) {
+            return static_cast<u32>(reinterpret_cast<uintptr_t>(handle));
+        }
+        static constexpr u64 pack(u32 key, FileKind kind) {
+            return (static_cast<u64>(key) << 32) | static_cast<u8>(kind);
+        }
+        static constexpr u32 keyOf(u64 value) {
+            return static_cast<u32>(value >> 32);
+        }
+        static constexpr FileKind kindOf(u64 value) {
+            return static_cast<FileKind>(value & 0xFF);
+        }
+        static constexpr size_t home(u32 key) {
+            // Handle values are multiples of 4, drop those bits before mixing
+            return static_cast<size_t>(((key >> 2) * 0x9E3779B1u) >> 8) & (capacity - 1);
+        }
+
+        std::array<Slot, capacity> slots{};
+    };
+}
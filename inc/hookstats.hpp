@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+namespace Utils
+{
+#ifdef HOOK_STATS
+    constexpr bool hookStatsEnabled = true;
+#else
+    constexpr bool hookStatsEnabled = false;
+#endif
+
+    /**
+     * @brief Opt-in hit counters and cycle histograms for the hooks.
+     * @details Compiled in with the CMake option `HOOK_STATS`, otherwise every function here is
+     *      an empty inline and costs nothing.
+     *
+     *      C++ hooks time themselves with `HookTimer`. Each thread records into its own block of
+     *      counters, which only it writes, so recording takes no locks and no `lock` prefixed
+     *      instructions. Cycles are measured with RDTSC and bucketed by log2. Code caves are a
+     *      handful of instructions and timing them would cost more than they do, they only count
+     *      hits with a `lock inc` on `caveCounter`.
+     *
+     *      `start` launches a thread that sums all blocks and logs what happened per hook since
+     *      the previous report.
+     */
+    class HookStats {
+    public:
+        static constexpr size_t maxHooks = 16;
+        static constexpr size_t buckets = 32;
+
+#ifdef HOOK_STATS
+        /**
+         * @brief Registers a hook, call before the hook is installed.
+         *
+         * @param name Name the hook is reported under.
+         * @return std::uint32_t Id to record with. The last id is reserved, every hook past the
+         *      first `maxHooks - 1` shares it and is reported as "other".
+         */
+        static std::uint32_t add(const std::string& name);
+
+        /**
+         * @brief Records one hit of a hook on the calling thread.
+         *
+         * @param id Id from `add`.
+         * @param cycles Cycles the hit took.
+         */
+        static void record(std::uint32_t id, std::uint64_t cycles);
+
+        /**
+         * @brief Hit counter incremented by a code cave.
+         *
+         * @param id Id from `add`.
+         */
+        static std::atomic<std::uint32_t>* caveCounter(std::uint32_t id);
+
+        /**
+         * @brief Starts logging a report every `intervalMs`.
+         *
+         * @param intervalMs Milliseconds between reports.
+         */
+        static void start(std::uint32_t intervalMs);
+#else
+        static std::uint32_t add(const std::string&) { return 0; }
+        static void record(std::uint32_t, std::uint64_t) {}
+        static std::atomic<std::uint32_t>* caveCounter(std::uint32_t) { return nullptr; }
+        static void start(std::uint32_t) {}
+#endif
+    };
+
+    /**
+     * @brief Times the scope it lives in and records it as one hit of a hook.
+     */
+    class HookTimer {
+    public:
+#ifdef HOOK_STATS
+        explicit HookTimer(std::uint32_t id) : id(id), begin(__rdtsc()) {}
+        ~HookTimer() { HookStats::record(id, __rdtsc() - begin); }
+
+    private:
+        std::uint32_t id;
+        std::uint64_t begin;
+#else
+        explicit HookTimer(std::uint32_t) {}
+#endif
+    };
+}
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "safetyhook.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Installs a batch of hooks while the game's threads are frozen once.
+     * @details Installing a hook suspends every other thread so no thread runs the bytes being
+     *      overwritten, done per hook that is a whole-process freeze for each one. Open a
+     *      transaction around the fixes instead: `CodeCave::install` and hooks added with `add`
+     *      only queue their patch while a transaction is open on the calling thread. `commit` then freezes all other threads once, writes every code cave
+     *      patch, moves threads caught inside the displaced instructions and resumes. The queued
+     *      safetyhook hooks are enabled after that, each doing its own freeze and thread fixups.
+     *
+     *      A transaction is all-or-nothing, if any hook fails to enable every hook already enabled
+     *      is disabled again, the code cave patches are restored under another freeze and the
+     *      failure is logged once for the batch. Safetyhook hooks have to be created with
+     *      `StartDisabled` to be queued.
+     *
+     *      Everything is prepared before the freeze, while it lasts nothing but the patch writes,
+     *      `VirtualProtect` and the instruction pointer moves run, nothing allocates as a frozen
+     *      thread may be holding the heap lock. Safetyhook's `enable` allocates, which is why it
+     *      never runs inside this freeze.
+     */
+    class HookTransaction {
+    public:
+        /**
+         * @brief Opens a transaction on the calling thread.
+         * @param name Name the transaction is logged and traced under.
+         */
+        explicit HookTransaction(std::string name);
+
+        /**
+         * @brief Closes the transaction, queued hooks that were never committed stay uninstalled.
+         */
+        ~HookTransaction();
+
+        HookTransaction(const HookTransaction&) = delete;
+        HookTransaction& operator=(const HookTransaction&) = delete;
+
+        /**
+         * @brief The innermost transaction open on the calling thread.
+         * @return HookTransaction* The transaction, or nullptr if none is open.
+         */
+        static HookTransaction* current();
+
+        /**
+         * @brief Queues bytes to be written over a hook site.
+         *
+         * @param name Name of the hook, for the log.
+         * @param site Address the bytes are written to.
+         * @param bytes Bytes to write, the site's current bytes are kept for the rollback.
+         * @param moves Pairs of addresses inside the site and where a thread found there is moved to.
+         */
+        void addPatch(std::string name, std::uintptr_t site, std::vector<std::uint8_t> bytes,
+            std::vector<std::pair<std::uintptr_t, std::uintptr_t>> moves);
+
+        /**
+         * @brief Queues an inline hook created with `SafetyHookInline::StartDisabled`.
+         */
+        void add(std::string name, SafetyHookInline& hook);
+
+        /**
+         * @brief Writes the queued patches under a single freeze, then enables the queued hooks.
+         * @return bool True if every patch and hook was installed, false if none was.
+         */
+        bool commit();
+
+    private:
+        struct Patch {
+            std::string name;
+            std::uintptr_t site;
+            std::vector<std::uint8_t> bytes;
+            std::vector<std::uint8_t> original;
+            std::vector<std::pair<std::uintptr_t, std::uintptr_t>> moves;
+        };
+
+        struct Hook {
+            std::string name;
+            std::function<bool()> enable;
+            std::function<void()> disable;
+        };
+
+        std::string name;
+        std::vector<Patch> patches;
+        std::vector<Hook> hooks;
+        HookTransaction* previous;
+        bool committed = false;
+    };
+}
@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <windows.h>
+
+namespace Utils
+{
+    /**
+     * @brief DirectShow filter graph methods that start and end movie playback.
+     */
+    struct FilterGraphMethods {
+        void* run = nullptr;
+        void* stop = nullptr;
+        void* getEvent = nullptr;
+    };
+
+    /**
+     * @brief Finds `IMediaControl::Run`, `IMediaControl::Stop` and `IMediaEvent::GetEvent` in quartz.dll.
+     * @details Creates a throwaway filter graph and reads the addresses out of its vtables, which
+     *      every filter graph in the process shares. quartz.dll is pinned so the addresses stay
+     *      valid after the throwaway graph is released.
+     *
+     * @return FilterGraphMethods with nullptr for anything that could not be found.
+     */
+    FilterGraphMethods findFilterGraphMethods();
+
+    /**
+     * @brief Whether a filter graph renders video, DirectShow also plays audio only graphs.
+     *
+     * @param graph Any interface of the graph.
+     * @return true if the graph has a video renderer connected.
+     */
+    bool graphHasVideo(IUnknown* graph);
+
+    /**
+     * @brief COM identity of an object, the same for all of its interfaces.
+     *
+     * @param object Any interface of the object.
+     * @return const void* Its IUnknown, only for comparing, no reference is held.
+     */
+    const void* comIdentity(IUnknown* object);
+
+    /**
+     * @brief Whether a filter graph event ends playback, on completion or abort.
+     */
+    bool isPlaybackEnd(long eventCode);
+}
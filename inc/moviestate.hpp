@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Movie playback state shared between the DirectShow or I/O hooks and the render hooks.
+     * @details DirectShow streams movies on its own threads while the render thread polls the
+     *      state every frame, so it lives in atomics. Every access is relaxed, nothing else is
+     *      published through it and neither hot path pays for a fence or a lock.
+     *
+     *      The DirectShow hooks know exactly when a movie starts and ends and call `setPlaying`.
+     *      Inferred from reads instead, reads of other files only end playback after `hysteresis` of them in a row, a single
+     *      stray read while a movie streams does not bounce the resolution. Each transition bumps
+     *      `sequence()` so readers can tell a new movie from the one they already saw, `movie()`
+     *      numbers them. A transition is a single compare-exchange on `playing`, when several
+     *      threads race for the same one only the winner bumps the counter.
+     *
+     *      `playing` is the first member and a plain byte, code patched into the game may test it
+     *      directly with `cmp byte ptr [state], 0`.
+     */
+    class MovieState {
+    public:
+        /**
+         * @brief Constructs the state as not playing.
+         *
+         * @param hysteresis Consecutive non-movie reads needed to end playback, 0 acts as 1.
+         */
+        explicit MovieState(u32 hysteresis = 1) : hysteresis(hysteresis == 0 ? 1 : hysteresis) {}
+
+        /**
+         * @brief Changes the hysteresis, see the constructor.
+         */
+        void setHysteresis(u32 reads) {
+            hysteresis.store(reads == 0 ? 1 : reads, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Starts or ends playback on an exact signal, such as the movie's graph running.
+         */
+        void setPlaying(bool value) {
+            strayReads.store(0, std::memory_order_relaxed);
+            transition(!value, value);
+        }
+
+        /**
+         * @brief Records a read from a movie file, starts playback if it was not already.
+         */
+        void onMovieRead() {
+            if (strayReads.load(std::memory_order_relaxed) != 0) {
+                strayReads.store(0, std::memory_order_relaxed);
+            }
+            // Checked first, the compare-exchange is a locked instruction and movies are read constantly
+            if (playing.load(std::memory_order_relaxed) == false) {
+                transition(false, true);
+            }
+        }
+
+        /**
+         * @brief Records a read from any other named file, may end playback.
+         */
+        void onOtherRead() {
+            if (playing.load(std::memory_order_relaxed) == false) {
+                return;
+            }
+            u32 strays = strayReads.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (strays >= hysteresis.load(std::memory_order_relaxed)) {
+                strayReads.store(0, std::memory_order_relaxed);
+                transition(true, false);
+            }
+        }
+
+        /**
+         * @brief Is a movie playing right now.
+         */
+        bool isPlaying() const {
+            return playing.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Number of transitions so far, odd while a movie plays.
+         * @details Bumped right after `playing` flips, for a moment after a transition the two
+         *      can disagree.
+         */
+        u32 sequence() const {
+            return sequenceCount.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Number of the movie playing, counting from 1, 0 if none is.
+         */
+        u32 movie() const {
+            u32 count = sequence();
+            return (count & 1) ? count / 2 + 1 : 0;
+        }
+
+        /**
+         * @brief Address of the playing byte, for code that tests it without calling in.
+         */
+        const void* playingAddress() const {
+            return &playing;
+        }
+
+    private:
+        /**
+         * Flips `playing` from `from` to `to`, only the thread that does it bumps the sequence.
+         */
+        void transition(bool from, bool to) {
+            if (playing.compare_exchange_strong(from, to, std::memory_order_relaxed)) {
+                sequenceCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<bool> playing = false;
+        std::atomic<u32> strayReads = 0;
+        std::atomic<u32> sequenceCount = 0;
+        std::atomic<u32> hysteresis;
+
+        static_assert(sizeof(std::atomic<bool>) == 1 && std::atomic<bool>::is_always_lock_free,
+            "MovieState::playing must be a plain lock-free byte");
+    };
+}
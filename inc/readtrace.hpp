@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <windows.h>
+#include <cstdint>
+#include <string>
+
+namespace Utils
+{
+    /**
+     * @brief Records the game's archive reads and replays them at the next launch.
+     * @details For the first `recordSeconds` of a session every read of a `.qpck` archive is
+     *      recorded as archive, offset and length. Reads continuing where the previous one of the
+     *      same archive ended are merged, as the game streams in small chunks most of a session
+     *      collapses into a few large records. Recording stops at `maxRecords` records or
+     *      `maxBytes` bytes read, whichever comes first, then the trace is written. Reads of
+     *      more than `maxArchives` archives or open handles are not recorded.
+     *
+     *      At the next launch a background thread reads the trace back in the order the game
+     *      asked for it, with background I/O priority, so the main menu and hub load from a warm
+     *      page cache instead of a cold disk. The trace belongs to one exe build, one recorded by
+     *      another build is ignored and replaced.
+     *
+     *      Trace file layout, little endian:
+     *      - Header: magic `GERT`, version, the exe's TimeDateStamp, archive and record count,
+     *        all u32.
+     *      - Archives: u16 length followed by that many UTF-16 characters, the archive's file
+     *        name, archives are opened from the game folder.
+     *      - Records: u32 archive index, u32 length, u64 offset.
+     *
+     *      Replay reads go around the hooks, `isReplayThread` tells the hooks to ignore them.
+     */
+    class ReadTrace {
+    public:
+        static constexpr std::uint32_t maxRecords = 32768;
+        static constexpr std::uint64_t maxBytes = 1024ull * 1024 * 1024;
+        static constexpr std::uint32_t maxMerge = 1024 * 1024;
+        static constexpr std::uint32_t maxArchives = 64;
+
+        /**
+         * @brief Starts replaying the previous trace and recording this session.
+         *
+         * @param path Trace file.
+         * @param timeDateStamp TimeDateStamp of the exe, traces of other builds are not replayed.
+         * @param recordSeconds How long this session is recorded for.
+         */
+        static void start(const std::string& path, std::uint32_t timeDateStamp, std::uint32_t recordSeconds);
+
+        /**
+         * @brief True while reads are being recorded, cheap enough to test on every read.
+         */
+        static bool recording();
+
+        /**
+         * @brief Records a read of an archive.
+         *
+         * @param file Handle to the archive.
+         * @param offset Offset the read starts at.
+         * @param length Number of bytes requested.
+         */
+        static void record(HANDLE file, std::uint64_t offset, std::uint32_t length);
+
+        /**
+         * @brief Forgets an archive handle, call for every handle that is closed.
+         */
+        static void close(HANDLE file);
+
+        /**
+         * @brief True on the thread replaying the trace.
+         */
+        static bool isReplayThread();
+    };
+}
@@ -0,0 +1,48 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "utils.hpp"
+
+/**
+ * @brief Every signature the fixes hook, shared with the GodEater1-2Fix-sigbench tool so it checks
+ * exactly what the mod ships with.
+ */
+inline Utils::SignatureHook aspectRatioSignature("F3 0F 11 05 ?? ?? ?? ??    E8 ?? ?? ?? ??    89 EC", 0, "", "aspectRatioFix");
+inline Utils::SignatureHook resolutionSignature(
+    "76 ??    F3 0F 59 05 ?? ?? ?? ??    F3 0F 5E 05 ?? ?? ?? ??    E8 ?? ?? ?? ??",
+    18, "", "resolutionFix"
+);
+inline Utils::SignatureHook hudElementsSignature("F3 0F 6F 00    F3 0F 7F 41 0C    F3 0F 6F 40 10", 0, "", "hudElementsFix");
+inline Utils::SignatureHook nativeResolutionSignature("80 07 00 00 38 04 00 00", 0, ".data", "nativeResolutionFix");
+
+inline const std::array<Utils::SignatureHook*, 4> allSignatures = {
+    &aspectRatioSignature,
+    &resolutionSignature,
+    &hudElementsSignature,
+    &nativeResolutionSignature,
+};
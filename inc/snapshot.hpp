@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Immutable snapshots of a value published to lock-free readers.
+     * @details Readers load the current snapshot pointer and read through it, nothing else, so
+     *      reading costs one plain load on x86. A writer fills the next of `N` statically
+     *      allocated slots and publishes it with a single atomic pointer store, nothing is
+     *      allocated or freed.
+     *
+     *      Each publish starts a new epoch. A slot is only written again `N` epochs after it
+     *      was retired, which is the grace period readers have to let go of it. Writers must
+     *      keep publishes far enough apart that no reader holds a pointer that long, readers
+     *      only ever hold it for a handful of instructions. There must only be one writer at
+     *      a time.
+     *
+     * @tparam T Trivially copyable value type.
+     * @tparam N Number of slots, the grace period in epochs.
+     */
+    template <typename T, size_t N = 8>
+    class SnapshotRing {
+    public:
+        /**
+         * @brief The current snapshot, never null.
+         */
+        const T* current() const {
+            return live.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Address of the snapshot pointer, for code that loads it without calling in.
+         */
+        const void* currentAddress() const {
+            return &live;
+        }
+
+        /**
+         * @brief Number of snapshots published so far.
+         */
+        u32 epoch() const {
+            return epochCount;
+        }
+
+        /**
+         * @brief Publishes a new snapshot, see the grace period in the class description.
+         *
+         * @param value Value of the new snapshot.
+         */
+        void publish(const T& value) {
+            T& slot = slots[++epochCount % N];
+            slot = value;
+            live.store(&slot, std::memory_order_release);
+        }
+
+    private:
+        std::array<T, N> slots = {};
+        u32 epochCount = 0;
+        std::atomic<const T*> live = &slots[0];
+
+        static_assert(N >= 2, "SnapshotRing needs a spare slot to write into");
+        static_assert(sizeof(std::atomic<const T*>) == sizeof(const T*) && std::atomic<const T*>::is_always_lock_free,
+            "SnapshotRing::live must be a plain lock-free pointer");
+    };
+}
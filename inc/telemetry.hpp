@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <windows.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Per-frame timings of the present path, captured on a hotkey and written as CSV.
+     * @details The present hook marks three points of every frame: when the game calls Present,
+     *      when the frame pacer let it through and when the original Present returned. From these
+     *      each frame gets its frame time, the CPU time the game spent between two presents, the
+     *      time spent pacing and the time spent in Present itself.
+     *
+     *      Frames go into a preallocated ring of `capacity` entries, a capture longer than that
+     *      keeps the most recent frames. Nothing is allocated or locked per frame and with no
+     *      capture running the present hook only tests a flag.
+     *
+     *      `startHotkey` polls the hotkey on its own thread. The first press starts a capture, the
+     *      second stops it and writes the CSV from that same thread, off the render thread, once
+     *      the frame in flight had time to finish.
+     *
+     *      `beginFrame`, `pacedFrame` and `endFrame` are only meant to be called from the thread
+     *      presenting.
+     */
+    class FrameTelemetry {
+    public:
+        static constexpr size_t capacity = 32768;
+
+        struct Frame {
+            i64 begin;
+            f32 frameMs;
+            f32 cpuMs;
+            f32 waitMs;
+            f32 presentMs;
+            u32 hudHits;
+            u32 movie;
+        };
+
+        /**
+         * @brief True while a capture runs.
+         */
+        bool capturing() const {
+            return active.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Marks the game calling Present.
+         */
+        void beginFrame();
+
+        /**
+         * @brief Marks the frame pacer letting the frame through.
+         */
+        void pacedFrame();
+
+        /**
+         * @brief Marks the original Present returning and records the frame.
+         *
+         * @param movie Number of the movie playing during the frame, see `MovieState::movie`, 0 if none.
+         * @param hudHits Number of times the HUD hook ran during the frame.
+         */
+        void endFrame(u32 movie, u32 hudHits);
+
+        /**
+         * @brief Starts the thread toggling captures on a hotkey.
+         *
+         * @param virtualKey Virtual key code of the hotkey.
+         * @param path CSV file each capture is written to, replaced by the next capture.
+         */
+        void startHotkey(u32 virtualKey, const std::string& path);
+
+    private:
+        static DWORD WINAPI hotkeyThread(void* parameter);
+        bool write() const;
+
+        std::array<Frame, capacity> frames{};
+        std::atomic<bool> active = false;
+        std::atomic<u64> count = 0;
+        i64 frequency = 0;
+        i64 captureBegin = 0;
+        i64 previousBegin = 0;
+        i64 previousEnd = 0;
+        i64 frameBegin = 0;
+        i64 paced = 0;
+        u32 virtualKey = 0;
+        std::string path;
+    };
+}
@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <windows.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils.hpp"
+
+namespace Utils
+{
+    /**
+     * @brief Applies scheduling rules from the config to the game's threads.
+     * @details A background thread lists the process's threads with Toolhelp every
+     *      `intervalMs` and sorts each new one into a role:
+     *
+     *      - **Render:** The thread presenting, reported by the Present hook.
+     *      - **Streaming:** Threads reading the `.qpck` archives, reported by the ReadFile hook.
+     *      - **Movie:** DirectShow's threads, they start in quartz.dll.
+     *      - **Worker:** Any other thread started by the game's exe.
+     *
+     *      Threads of system libraries and drivers are left alone, so are the mod's own which pick
+     *      their own priorities. Each thread is given its role's rule once, and again only if it
+     *      later turns out to have another role.
+     *
+     *      A rule sets the thread priority, the cores the thread prefers and its power throttling.
+     *      Cores are chosen through CPU sets, on hybrid CPUs the performance cores are the ones of
+     *      the highest efficiency class. CPU sets and power throttling are looked up at runtime
+     *      and skipped on Windows versions without them.
+     */
+    class ThreadManager {
+    public:
+        enum class Role : u8 {
+            Render = 0,
+            Streaming,
+            Movie,
+            Worker,
+        };
+
+        enum class Cores : u8 {
+            Unchanged = 0,
+            All,
+            Performance,
+            Efficiency,
+        };
+
+        enum class Qos : u8 {
+            Unchanged = 0,
+            High,
+            Eco,
+        };
+
+        struct Rule {
+            bool setPriority = false;
+            int priority = THREAD_PRIORITY_NORMAL;
+            Cores cores = Cores::Unchanged;
+            Qos qos = Qos::Unchanged;
+        };
+
+        /**
+         * @brief Parses a rule from the config, unknown values are logged and left unchanged.
+         *
+         * @param priority idle, lowest, below_normal, normal, above_normal, highest, time_critical or unchanged.
+         * @param cores all, performance, efficiency or unchanged.
+         * @param qos high, eco or unchanged.
+         * @return Rule parsed.
+         */
+        static Rule parseRule(const std::string& priority, const std::string& cores, const std::string& qos);
+
+        /**
+         * @brief Sets the rule of a role, call before `start`.
+         */
+        void setRule(Role role, const Rule& rule);
+
+        /**
+         * @brief Reports the calling thread as the render thread, cheap enough to call every frame.
+         */
+        void noteRenderThread() {
+            if (renderThread.load(std::memory_order_relaxed) == 0) {
+                renderThread.store(GetCurrentThreadId(), std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Reports the calling thread as streaming, cheap enough to call on every read.
+         * @details Up to `maxStreaming` threads are remembered, any more are treated as workers.
+         */
+        void noteStreamingThread() {
+            DWORD id = GetCurrentThreadId();
+            for (std::atomic<DWORD>& slot : streamingThreads) {
+                DWORD current = slot.load(std::memory_order_relaxed);
+                if (current == id) {
+                    return;
+                }
+                if (current == 0) {
+                    slot.compare_exchange_strong(current, id, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * @brief Starts applying the rules, every `intervalMs` on a background thread.
+         */
+        void start(u32 intervalMs);
+
+    private:
+        static constexpr size_t maxStreaming = 8;
+
+        static DWORD WINAPI managerThread(void* parameter);
+        void scan();
+        void apply(DWORD id, Role role);
+
+        std::array<Rule, 4> rules{};
+        std::atomic<DWORD> renderThread = 0;
+        std::array<std::atomic<DWORD>, maxStreaming> streamingThreads{};
+        std::unordered_map<DWORD, u8> applied;
+        std::vector<ULONG> performanceSets;
+        std::vector<ULONG> efficiencySets;
+        u32 intervalMs = 5000;
+    };
+}
@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Utils
+{
+    /**
+     * @brief Timeline of the mod's startup in Chrome trace format.
+     * @details Scopes are timed with QPC against the creation time of the process, so every
+     *      timestamp reads as time since the game was launched. Events are kept in memory
+     *      behind a mutex, this is meant for one-off startup work and not for hooks that run
+     *      every frame. `write` produces a `trace.json` that chrome://tracing and
+     *      ui.perfetto.dev open directly.
+     */
+    class Trace {
+    public:
+        /**
+         * @brief Milliseconds since the process was created.
+         */
+        static double msSinceProcessStart();
+
+        /**
+         * @brief Records a complete event.
+         *
+         * @param name Name shown on the timeline.
+         * @param beginUs Start in microseconds since the process was created.
+         * @param endUs End in microseconds since the process was created.
+         */
+        static void add(std::string name, double beginUs, double endUs);
+
+        /**
+         * @brief Writes every event recorded so far.
+         *
+         * @param path Path of the file to write.
+         * @return true if the file was written.
+         */
+        static bool write(const std::string& path);
+    };
+
+    /**
+     * @brief Records the scope it lives in as one event of the startup trace.
+     */
+    class TraceScope {
+    public:
+        explicit TraceScope(std::string name);
+        ~TraceScope();
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        std::string name;
+        double beginUs;
+    };
+}
@@ -29,13 +29,21 @@
 #include <string>
 #include <cstdint>
 #include <span>
+#include <array>
+#include <algorithm>
+#include <string_view>
 
 // 3rd party includes
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/basic_file_sink.h"
-#include "yaml-cpp/yaml.h"
 #include "safetyhook.hpp"
 
+// Local includes
+#include "allocaudit.hpp"
+#include "hookstats.hpp"
+#include "hooktransaction.hpp"
+#include "trace.hpp"
+
 #define LOG(STRING, ...) spdlog::info("{} : " STRING, __func__, ##__VA_ARGS__)
 
 namespace
@@ -58,14 +66,211 @@ namespace Utils
     public:
         HMODULE address;
         std::string name;
-        ModuleInfo(HMODULE address) : address(address) {}
+        u32 timeDateStamp = 0;
+        u32 sizeOfImage = 0;
+        u32 checkSum = 0;
+        ModuleInfo(HMODULE address) : address(address) {
+            auto dosHeader = reinterpret_cast<PIMAGE_DOS_HEADER>(address);
+            auto ntHeaders = reinterpret_cast<PIMAGE_NT_HEADERS>(reinterpret_cast<u8*>(address) + dosHeader->e_lfanew);
+            timeDateStamp = ntHeaders->FileHeader.TimeDateStamp;
+            sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+            checkSum = ntHeaders->OptionalHeader.CheckSum;
+        }
+    };
+
+    // Not constexpr on purpose, reaching one of these while parsing a signature fails the build
+    // and the function name shows up in the compiler error.
+    inline void signatureHasInvalidByte() {}
+    inline void signatureIsTooLong() {}
+    inline void signatureIsEmpty() {}
+
+    /**
+     * @brief IDA-style byte pattern parsed at compile time.
+     * @details A string literal such as `"F3 0F 11 05 ?? ?? ?? ??"` is turned into fixed-size
+     *      byte and mask arrays by the consteval constructor. Bytes are two hex digits and
+     *      wildcards are `??` or `?`, separated by any amount of whitespace. Malformed patterns,
+     *      empty patterns and patterns longer than `capacity` bytes fail the build.
+     *
+     *      The two rarest non-wildcard bytes are also picked at compile time as anchors for
+     *      the scanner, `anchor0` being the rarest. If there is a single non-wildcard byte both
+     *      anchors are the same index, if there is none both are `size`.
+     */
+    class Signature {
+    public:
+        static constexpr size_t capacity = 64;
+
+        std::array<u8, capacity> bytes{};
+        std::array<u8, capacity> mask{};
+        size_t size = 0;
+        size_t anchor0 = 0;
+        size_t anchor1 = 0;
+        std::string_view text;
+
+        consteval Signature(const char* pattern) : text(pattern) {
+            for (size_t i = 0; i < text.size();) {
+                if (text[i] == ' ' || text[i] == '\t') {
+                    ++i;
+                    continue;
+                }
+                if (size == capacity) {
+                    signatureIsTooLong();
+                }
+                if (text[i] == '?') {
+                    i += (i + 1 < text.size() && text[i + 1] == '?') ? 2 : 1;
+                    mask[size++] = 0x00;
+                }
+                else {
+                    if (i + 1 >= text.size()) {
+                        signatureHasInvalidByte();
+                    }
+                    bytes[size] = static_cast<u8>((hexDigit(text[i]) << 4) | hexDigit(text[i + 1]));
+                    mask[size++] = 0xFF;
+                    i += 2;
+                }
+                if (i < text.size() && text[i] != ' ' && text[i] != '\t') {
+                    signatureHasInvalidByte();
+                }
+            }
+            if (size == 0) {
+                signatureIsEmpty();
+            }
+            pickAnchors();
+        }
+
+    private:
+        /**
+         * Bytes that show up the most in x86 machine code, roughly in order of frequency. Anything
+         * not listed here is considered rare, and the later a byte appears the rarer it is.
+         */
+        static constexpr u8 commonBytes[] = {
+            0x00, 0xFF, 0x8B, 0xCC, 0x89, 0x0F, 0xE8, 0x24, 0x45, 0x83, 0x04, 0x01, 0x85, 0x74, 0x75, 0x08,
+            0x44, 0x10, 0x8D, 0xC3, 0x50, 0x56, 0x57, 0x55, 0x5E, 0x5F, 0x5D, 0x0C, 0xF3, 0xC7, 0x33, 0xEB,
+            0x66, 0x02, 0x40, 0x80, 0x03, 0xC0, 0x14, 0x18, 0x06, 0x1C, 0x20, 0x51, 0x53, 0x52, 0x3B, 0x90,
+        };
+
+        static constexpr u8 hexDigit(char c) {
+            if (c >= '0' && c <= '9') return static_cast<u8>(c - '0');
+            if (c >= 'A' && c <= 'F') return static_cast<u8>(c - 'A' + 10);
+            if (c >= 'a' && c <= 'f') return static_cast<u8>(c - 'a' + 10);
+            signatureHasInvalidByte();
+            return 0;
+        }
+
+        static constexpr u32 rarity(u8 byte) {
+            u32 rank = 0;
+            while (rank < std::size(commonBytes) && commonBytes[rank] != byte) {
+                ++rank;
+            }
+            return rank;
+        }
+
+        constexpr void pickAnchors() {
+            anchor0 = size;
+            anchor1 = size;
+            for (size_t i = 0; i < size; ++i) {
+                if (mask[i] == 0) {
+                    continue;
+                }
+                if (anchor0 == size || rarity(bytes[i]) > rarity(bytes[anchor0])) {
+                    anchor1 = anchor0;
+                    anchor0 = i;
+                }
+                else if (anchor1 == size || rarity(bytes[i]) > rarity(bytes[anchor1])) {
+                    anchor1 = i;
+                }
+            }
+            if (anchor1 == size) {
+                anchor1 = anchor0;
+            }
+        }
     };
 
     class SignatureHook {
     public:
-        std::string signature;
+        Signature signature;
         u64 offset;
-        SignatureHook(std::string signature, u64 offset = 0) : signature(signature), offset(offset) {}
+        std::string section;
+        std::string name;
+        bool scanned = false;
+        std::vector<uintptr_t> hits;
+        SignatureHook(Signature signature, u64 offset = 0, std::string section = "", std::string name = "")
+            : signature(signature), offset(offset), section(section), name(name) {}
+    };
+
+    /**
+     * @brief Implementation `Utils::patternScan` compares memory with.
+     *
+     * - **Auto:** AVX2 if the CPU has it, SSE2 otherwise.
+     * - **Scalar:** One byte at a time, the reference the others must match.
+     * - **Sse2:** 16 bytes at a time.
+     * - **Avx2:** 32 bytes at a time, falls back to SSE2 if the CPU lacks AVX2.
+     */
+    enum class ScanEngine : u8 {
+        Auto = 0,
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    /**
+     * @brief String of at most `Capacity` characters stored inline, for paths that hooks and
+     *      code on the per-read path handle without allocating.
+     * @details Always null terminated. Text that does not fit is rejected rather than cut,
+     *      a truncated path would name another file.
+     */
+    template <typename Char, size_t Capacity>
+    class FixedString {
+    public:
+        FixedString() = default;
+
+        /**
+         * @brief Replaces the contents.
+         *
+         * @param text Text to copy.
+         * @return true if it fit, false leaves the string empty.
+         */
+        bool assign(std::basic_string_view<Char> text) {
+            length = 0;
+            buffer[0] = Char{};
+            return append(text);
+        }
+
+        /**
+         * @brief Appends to the contents.
+         *
+         * @param text Text to copy.
+         * @return true if it fit, false leaves the string unchanged.
+         */
+        bool append(std::basic_string_view<Char> text) {
+            if (text.size() > Capacity - length) {
+                return false;
+            }
+            std::copy(text.begin(), text.end(), buffer.begin() + length);
+            length += text.size();
+            buffer[length] = Char{};
+            return true;
+        }
+
+        std::basic_string_view<Char> view() const { return { buffer.data(), length }; }
+        const Char* c_str() const { return buffer.data(); }
+        size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+
+        bool operator==(const FixedString& other) const { return view() == other.view(); }
+
+    private:
+        std::array<Char, Capacity + 1> buffer{};
+        size_t length = 0;
+    };
+
+    using FixedPath = FixedString<wchar_t, MAX_PATH>;
+
+    class Section {
+    public:
+        std::string name;
+        const u8* begin;
+        size_t size;
+        bool executable;
     };
 
     /**
@@ -114,71 +319,151 @@ namespace Utils
 
     /**
      * @brief Patch an area of memory with a pattern.
-     * @details Overwrites memory at `address` using the provided pattern. The `pattern`
-     *      must be formatted as a space-separated hex string (e.g., `"DE AD BE EF"`).
-     *      The function modifies memory at the specified address, spanning the number
-     *      of bytes determined by the pattern length. Proper care should be taken to
-     *      avoid segmentation faults or corruption of unintended memory regions.
+     * @details Overwrites memory at `address` using the provided pattern, which is parsed
+     *      at compile time (e.g., `"DE AD BE EF"`). Wildcard bytes are skipped and leave the
+     *      original byte in place. The function modifies memory at the specified address,
+     *      spanning the number of bytes determined by the pattern length. Proper care should
+     *      be taken to avoid segmentation faults or corruption of unintended memory regions.
      *
      * @param address Memory address to patch.
      * @param pattern IDA-style byte array pattern.
      */
-    void patch(u64 address, std::string& pattern);
+    void patch(u64 address, const Signature& pattern);
+
+    /**
+     * @brief Patch an area of memory with bytes known only at runtime.
+     * @details Same as the `Signature` overload but every byte is written, for values
+     *      computed from the config such as a resolution.
+     *
+     * @param address Memory address to patch.
+     * @param bytes Bytes to write.
+     */
+    void patch(u64 address, std::span<const u8> bytes);
+
+    /**
+     * @brief Get the sections of a module.
+     * @details Walks the section table of the module's PE headers. The size of each
+     *      section is its virtual size clamped to `SizeOfImage`. Sections are returned
+     *      sorted by address.
+     *
+     * @param module Base address of the module.
+     * @return std::vector<Section> containing the module's sections.
+     */
+    std::vector<Section> getSections(void* module);
 
     /**
      * @brief Scan for a given byte pattern in a module.
      * @details Searches the specified module's memory for occurrences of the given
-     *      IDA-style byte pattern. Each match is appended to the `address` vector.
-     *      Wildcard bytes ("??") can be used to match any byte in the pattern.
+     *      IDA-style byte pattern. Wildcard bytes ("??") can be used to match any byte
+     *      in the pattern. Only sections marked `IMAGE_SCN_MEM_EXECUTE` are scanned and
+     *      a match never spans two sections.
+     *
+     *      The two anchor bytes picked when the signature was parsed are used, and
+     *      32 (AVX2) or 16 (SSE2) offsets are tested against them per iteration. The
+     *      full masked compare only runs on offsets where both anchors match. AVX2 is
+     *      used when both the CPU and OS support it, otherwise SSE2.
      *
      * @param module Base address of the module to scan.
      * @param signature IDA-style byte array pattern.
-     * @param address Vector to store found addresses.
      *
      * @return uintptr_t containing the address of the first hit if the signature is
      *      found else 0.
      */
-    uintptr_t patternScan(void* module, std::string& signature);
+    uintptr_t patternScan(void* module, const Signature& signature);
 
     /**
-     * @brief Injects a mid-function hook based on a signature pattern match.
+     * @brief Forces the engine used by `Utils::patternScan`, meant for benchmarks.
+     *
+     * @param engine Engine to use from now on, `ScanEngine::Auto` by default.
+     */
+    void setScanEngine(ScanEngine engine);
+
+    /**
+     * @brief Can the CPU run an engine.
+     *
+     * @param engine Engine to check.
+     * @return true if `engine` runs as itself rather than falling back.
+     */
+    bool isScanEngineSupported(ScanEngine engine);
+
+    /**
+     * @brief Scan for several byte patterns in a module in a single pass.
+     * @details Resolves every signature in `hooks` with one walk over the module's memory.
+     *      Each signature is anchored on its rarest non-wildcard byte and a 256 entry
+     *      dispatch table maps a byte value to the signatures anchored on it. The memory
+     *      is filtered against all anchor bytes at once with AVX2/SSE2 and only bytes
+     *      that hit the table get the full masked compare.
+     *
+     *      Signatures without a section hint are only scanned for in executable sections,
+     *      a signature with `SignatureHook::section` set is only scanned for in the section
+     *      of that name, e.g. ".data" for a constant.
+     *
+     *      Every match is stored in `SignatureHook::hits` sorted by address, not only the
+     *      first, so signatures that are no longer unique can be reported. The hook is
+     *      marked as scanned even if nothing was found.
+     *
+     *      Sections of at least 1 MB per thread are split into chunks, up to one per thread. Each
+     *      chunk owns a range of start offsets and reads past its end by the length of the
+     *      longest signature - 1, so results are identical to a single-threaded scan. The
+     *      workers are started once per call and take chunks of every section off one queue.
      *
-     * @tparam Func The type of the callback function.
-     * @param enable If true, the hook will be injected; otherwise, it is skipped.
-     * @param module The module to scan for the signature.
+     * @param module Base address of the module to scan.
+     * @param hooks Signatures to resolve.
+     * @param threads Number of threads to scan with, 0 uses the hardware concurrency.
+     */
+    void patternScan(void* module, std::span<SignatureHook*> hooks, u32 threads = 1);
+
+    /**
+     * @brief Checks if a module is one of the known game builds.
+     * @details Known builds are generated at build time from cmake/KnownBuilds.csv and
+     *      identified by exe name, PE `TimeDateStamp` and `CheckSum`.
+     *
+     * @param module The module to check, `name` must already be set.
+     * @return true if the build is listed in the known builds table.
+     */
+    bool isKnownBuild(const Utils::ModuleInfo& module);
+
+    /**
+     * @brief Loads the signature resolution cache from disk.
+     * @details The cache maps an exe identity (name, PE `TimeDateStamp`, `SizeOfImage` and
+     *      `CheckSum`) plus a signature to the RVA it resolved to on a previous run. Entries
+     *      of other exes or other builds of the same exe are kept but never used. A missing
+     *      or unreadable file results in an empty cache.
+     *
+     *      Each line of the file is formatted as:
+     *      `<exe> <TimeDateStamp> <SizeOfImage> <CheckSum> <rva> <signature>`
+     *      with all numbers in hex.
+     *
+     * @param module The module signatures are resolved in, `name` must already be set.
+     * @param path Path to the cache file.
+     */
+    void loadSignatureCache(const Utils::ModuleInfo& module, const std::string& path);
+
+    /**
+     * @brief Resolves signatures using the cache first and scanning the rest.
+     * @details Hooks already scanned are skipped. For known builds the RVA comes straight
+     *      from the generated known builds table, otherwise the signature cache is checked.
+     *      A known or cached RVA is only used if the bytes at that address still match the
+     *      signature, otherwise it counts as a miss. All
+     *      misses are resolved together with a batch `Utils::patternScan`, new unique hits
+     *      are added to the cache and the cache is written back to disk. Signatures with
+     *      more than one hit are not cached and get scanned for on every run.
+     *
+     * @param module The module to resolve the signatures in.
+     * @param hooks Signatures to resolve.
+     * @param threads Number of threads to scan with, 0 uses the hardware concurrency.
+     */
+    void resolveSignatures(Utils::ModuleInfo& module, std::span<SignatureHook*> hooks, u32 threads = 1);
+
+    /**
+     * @brief Resolves the address a hook is placed at.
+     * @details Resolves the signature with `Utils::resolveSignatures` unless that already
+     *      happened, logs every hit if the signature is no longer unique and uses the first.
+     *
+     * @param module The module to resolve the signature in.
      * @param hook The signature pattern and offset information for the hook.
-     * @param callback The function to execute when the hook is triggered.
-     *
-     * @details
-     * This function scans the specified module for the given signature pattern.
-     * If a match is found, it calculates the absolute and relative addresses,
-     * logs the location, and applies a mid-function hook at the computed address.
-     *
-     * @note This function only hooks the first match found in the module.
-     *
-     * @see Utils::patternScan
-     */
-    template <typename Func>
-    void injectHook(bool enable, Utils::ModuleInfo& module, Utils::SignatureHook& hook, Func&& callback) {
-        LOG("Fix {}", enable ? "Enabled" : "Disabled");
-        if (enable) {
-            uintptr_t addr = Utils::patternScan(module.address, hook.signature);
-            if (addr != 0) {
-                u64 hit = addr;
-                u64 absAddr = hit;
-                u64 relAddr = hit - reinterpret_cast<u64>(module.address);
-                LOG("Found '{}' @ {:s}+{:x}", hook.signature, module.name, relAddr);
-                u64 hookAbsAddr = absAddr + hook.offset;
-                u64 hookRelAddr = relAddr + hook.offset;
-                static SafetyHookMid aspectRatioHook = safetyhook::create_mid(
-                    reinterpret_cast<void*>(hookAbsAddr),
-                    callback
-                );
-                LOG("Hooked @ {:s}+{:x}", module.name, hookRelAddr);
-            }
-            else {
-                LOG("Did not find '{}'", hook.signature);
-            }
-        }
-    }
+     * @return uintptr_t Absolute address of the first hit plus `SignatureHook::offset`, 0 if
+     *      the signature was not found.
+     */
+    uintptr_t resolveHook(Utils::ModuleInfo& module, Utils::SignatureHook& hook);
 }
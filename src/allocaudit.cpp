@@ -0,0 +1,257 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifdef HOOK_ALLOC_AUDIT
+
+#include <windows.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+#include "allocaudit.hpp"
+
+namespace
+{
+    using Utils::AllocAudit;
+
+    /**
+     * Counters of one hook, summed over all threads.
+     */
+    struct Counters {
+        std::atomic<u64> calls;
+        std::atomic<u64> allocatingCalls;
+        std::atomic<u64> allocations;
+        std::atomic<u64> maxPerCall;
+    };
+
+    /**
+     * Allocations a thread made in any hook, the slot is claimed on its first one.
+     */
+    struct ThreadSlot {
+        std::atomic<DWORD> id;
+        std::atomic<u64> allocations;
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::string> names;
+    std::array<Counters, AllocAudit::maxHooks> hooks;
+    std::array<ThreadSlot, AllocAudit::maxThreads> threads;
+    std::atomic<bool> armed = false;
+    u32 reportIntervalMs = 0;
+
+    // Plain thread locals, operator new may run before anything else on a thread is set up
+    thread_local u32 depth = 0;
+    thread_local u32 scopeAllocations = 0;
+    thread_local ThreadSlot* localSlot = nullptr;
+
+    ThreadSlot* claimSlot()
+    {
+        DWORD self = GetCurrentThreadId();
+        for (ThreadSlot& slot : threads) {
+            DWORD expected = 0;
+            if (slot.id.compare_exchange_strong(expected, self, std::memory_order_relaxed)) {
+                return &slot;
+            }
+        }
+        // Threads past maxThreads share the last slot
+        return &threads.back();
+    }
+
+    struct Totals {
+        u64 calls = 0;
+        u64 allocatingCalls = 0;
+        u64 allocations = 0;
+    };
+
+    DWORD WINAPI reportThread(void* lpParameter)
+    {
+        std::vector<Totals> previous;
+        std::array<u64, AllocAudit::maxThreads> previousThreads = {};
+        while (true) {
+            Sleep(reportIntervalMs);
+
+            std::vector<std::string> reported;
+            {
+                std::lock_guard lock(registryMutex);
+                reported = names;
+            }
+            previous.resize(reported.size());
+            for (size_t id = 0; id < reported.size(); ++id) {
+                Totals current;
+                current.calls = hooks[id].calls.load(std::memory_order_relaxed);
+                current.allocatingCalls = hooks[id].allocatingCalls.load(std::memory_order_relaxed);
+                current.allocations = hooks[id].allocations.load(std::memory_order_relaxed);
+                u64 allocations = current.allocations - previous[id].allocations;
+                if (allocations != 0) {
+                    LOG("{}: allocated {} times in {} of {} calls, at most {} in one call", reported[id], allocations,
+                        current.allocatingCalls - previous[id].allocatingCalls, current.calls - previous[id].calls,
+                        hooks[id].maxPerCall.load(std::memory_order_relaxed));
+                }
+                previous[id] = current;
+            }
+            for (size_t slot = 0; slot < threads.size(); ++slot) {
+                u64 allocations = threads[slot].allocations.load(std::memory_order_relaxed);
+                if (allocations != previousThreads[slot]) {
+                    LOG("Thread {}: allocated {} times in hooks", threads[slot].id.load(std::memory_order_relaxed),
+                        allocations - previousThreads[slot]);
+                    previousThreads[slot] = allocations;
+                }
+            }
+        }
+        return 0;
+    }
+}
+
+namespace Utils
+{
+    u32 AllocAudit::add(const std::string& name)
+    {
+        std::lock_guard lock(registryMutex);
+        // The last id is kept for "other" from the start, no hook's counts get relabelled
+        if (names.size() >= maxHooks - 1) {
+            if (names.size() == maxHooks - 1) {
+                names.push_back("other");
+            }
+            return maxHooks - 1;
+        }
+        names.push_back(name);
+        return static_cast<u32>(names.size() - 1);
+    }
+
+    u32 AllocAudit::enter()
+    {
+        u32 outer = scopeAllocations;
+        scopeAllocations = 0;
+        ++depth;
+        return outer;
+    }
+
+    void AllocAudit::leave(u32 id, u32 outer)
+    {
+        u32 allocations = scopeAllocations;
+        scopeAllocations = outer;
+        --depth;
+        if (!armed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        Counters& counters = hooks[id];
+        counters.calls.fetch_add(1, std::memory_order_relaxed);
+        if (allocations == 0) {
+            return;
+        }
+        counters.allocatingCalls.fetch_add(1, std::memory_order_relaxed);
+        counters.allocations.fetch_add(allocations, std::memory_order_relaxed);
+        u64 most = counters.maxPerCall.load(std::memory_order_relaxed);
+        while (most < allocations && !counters.maxPerCall.compare_exchange_weak(most, allocations, std::memory_order_relaxed)) {
+        }
+        if (localSlot == nullptr) {
+            localSlot = claimSlot();
+        }
+        localSlot->allocations.fetch_add(allocations, std::memory_order_relaxed);
+    }
+
+    void AllocAudit::count()
+    {
+        if (depth != 0) {
+            ++scopeAllocations;
+        }
+    }
+
+    void AllocAudit::start(u32 intervalMs)
+    {
+        reportIntervalMs = std::max<u32>(intervalMs, 100);
+        armed.store(true, std::memory_order_relaxed);
+        HANDLE reportHandle = CreateThread(nullptr, 0, reportThread, nullptr, 0, nullptr);
+        if (reportHandle) {
+            SetThreadPriority(reportHandle, THREAD_PRIORITY_LOWEST);
+            CloseHandle(reportHandle);
+        }
+        LOG("Auditing hook allocations, reporting every {} ms", reportIntervalMs);
+    }
+}
+
+// Replaces the mod's allocation functions, aligned new and delete keep the runtime's own
+void* operator new(size_t size)
+{
+    Utils::AllocAudit::count();
+    void* block = std::malloc(size == 0 ? 1 : size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    Utils::AllocAudit::count();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+    std::free(block);
+}
+
+#endif
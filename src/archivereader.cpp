@@ -0,0 +1,179 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <algorithm>
+#include <cstring>
+
+#include "archivereader.hpp"
+
+namespace
+{
+    /**
+     * Copies out of a mapped view, a failed page-in raises an exception instead of a read error.
+     * Kept free of anything with a destructor, SEH can not unwind C++ objects.
+     */
+    bool copyFromView(void* destination, const void* source, size_t size)
+    {
+#if defined(_MSC_VER)
+        __try {
+            std::memcpy(destination, source, size);
+        }
+        __except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+            return false;
+        }
+#else
+        std::memcpy(destination, source, size);
+#endif
+        return true;
+    }
+}
+
+namespace Utils
+{
+    bool ArchiveReader::read(HANDLE file, void* buffer, DWORD size, DWORD* read)
+    {
+        if (size == 0 || size > windowSize) {
+            return false;
+        }
+        std::unique_lock lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return false;
+        }
+
+        Archive* entry = find(file);
+        if (entry == nullptr) {
+            entry = find(nullptr);
+            if (entry == nullptr) {
+                return false;
+            }
+            // A mapping that can not be created is remembered too, the handle is not retried
+            *entry = { file, nullptr, 0 };
+            LARGE_INTEGER fileSize;
+            if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+                entry->mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                entry->size = static_cast<u64>(fileSize.QuadPart);
+            }
+        }
+        const Archive& archive = *entry;
+        if (archive.mapping == nullptr) {
+            return false;
+        }
+
+        LARGE_INTEGER position;
+        if (!SetFilePointerEx(file, LARGE_INTEGER{}, &position, FILE_CURRENT)) {
+            return false;
+        }
+        u64 offset = static_cast<u64>(position.QuadPart);
+        DWORD count = static_cast<DWORD>(std::min<u64>(size, offset < archive.size ? archive.size - offset : 0));
+        if (count == 0) {
+            *read = 0;
+            return true;
+        }
+
+        // No read is larger than a view, it touches at most two
+        u64 first = offset / windowSize;
+        u64 last = (offset + count - 1) / windowSize;
+        const u8* firstView = window(file, archive, first);
+        const u8* lastView = last == first ? firstView : window(file, archive, last);
+        if (firstView == nullptr || lastView == nullptr) {
+            return false;
+        }
+        size_t head = static_cast<size_t>(std::min<u64>(count, (first + 1) * windowSize - offset));
+        auto destination = static_cast<u8*>(buffer);
+        if (!copyFromView(destination, firstView + (offset - first * windowSize), head) ||
+            !copyFromView(destination + head, lastView, count - head)) {
+            return false;
+        }
+
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast<LONGLONG>(offset + count);
+        if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN)) {
+            return false;
+        }
+        *read = count;
+        return true;
+    }
+
+    void ArchiveReader::close(HANDLE file)
+    {
+        HANDLE mapping = nullptr;
+        {
+            std::lock_guard lock(mutex);
+            Archive* entry = find(file);
+            if (entry == nullptr) {
+                return;
+            }
+            mapping = entry->mapping;
+            *entry = {};
+            for (Window& window : windows) {
+                if (window.view != nullptr && window.file == file) {
+                    UnmapViewOfFile(window.view);
+                    window = {};
+                }
+            }
+        }
+        // Outside the lock, closing the mapping goes through the CloseHandle hook again
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+    }
+
+    ArchiveReader::Archive* ArchiveReader::find(HANDLE file)
+    {
+        for (Archive& archive : archives) {
+            if (archive.file == file) {
+                return &archive;
+            }
+        }
+        return nullptr;
+    }
+
+    const u8* ArchiveReader::window(HANDLE file, const Archive& archive, u64 index)
+    {
+        Window* victim = &windows[0];
+        for (Window& window : windows) {
+            if (window.view != nullptr && window.file == file && window.index == index) {
+                window.lastUse = ++uses;
+                return window.view;
+            }
+            if (window.lastUse < victim->lastUse) {
+                victim = &window;
+            }
+        }
+
+        if (victim->view != nullptr) {
+            UnmapViewOfFile(victim->view);
+            *victim = {};
+        }
+        u64 offset = index * windowSize;
+        size_t length = static_cast<size_t>(std::min<u64>(windowSize, archive.size - offset));
+        void* view = MapViewOfFile(archive.mapping, FILE_MAP_READ, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), length);
+        if (view == nullptr) {
+            return nullptr;
+        }
+        *victim = { file, index, static_cast<const u8*>(view), ++uses };
+        return victim->view;
+    }
+}
@@ -0,0 +1,290 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#include <Zydis/Zydis.h>
+
+#include "codecave.hpp"
+#include "hooktransaction.hpp"
+#include "trace.hpp"
+
+namespace
+{
+    /**
+     * Caves are carved out of executable blocks of this size, a new block is allocated once the
+     * current one is full.
+     */
+    constexpr size_t caveBlockSize = 64 * 1024;
+
+    /**
+     * Size of the `jmp rel32` written over the hook site.
+     */
+    constexpr size_t jmpSize = 5;
+
+    std::mutex caveBlockMutex;
+    u8* caveBlock = nullptr;
+    size_t caveBlockUsed = 0;
+
+    u8* allocateCave(size_t size)
+    {
+        std::lock_guard lock(caveBlockMutex);
+        size = (size + 15) & ~static_cast<size_t>(15);
+        if (size > caveBlockSize) {
+            return nullptr;
+        }
+        if (caveBlock == nullptr || caveBlockUsed + size > caveBlockSize) {
+            caveBlock = static_cast<u8*>(VirtualAlloc(nullptr, caveBlockSize, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+            caveBlockUsed = 0;
+            if (caveBlock == nullptr) {
+                return nullptr;
+            }
+        }
+        u8* cave = caveBlock + caveBlockUsed;
+        caveBlockUsed += size;
+        return cave;
+    }
+
+    /**
+     * Appends a `call`/`jmp rel32` located at `from` that lands on `to`.
+     */
+    void emitRel32(std::vector<u8>& code, u8 opcode, uintptr_t from, uintptr_t to)
+    {
+        i32 rel = static_cast<i32>(to - (from + jmpSize));
+        code.push_back(opcode);
+        code.insert(code.end(), reinterpret_cast<const u8*>(&rel), reinterpret_cast<const u8*>(&rel) + sizeof(rel));
+    }
+}
+
+namespace Utils
+{
+    void CodeCave::movssXmm0(const void* source)
+    {
+        emit(std::array<u8, 4>{ 0xF3, 0x0F, 0x10, 0x05 });
+        emitAddress(source);
+    }
+
+    void CodeCave::movssXmm0(Reg base, i8 disp)
+    {
+        emit(std::array<u8, 3>{ 0xF3, 0x0F, 0x10 });
+        emitModRm(0b01, 0, static_cast<u8>(base));
+        code.push_back(static_cast<u8>(disp));
+    }
+
+    void CodeCave::cmpByte(const void* address, u8 value)
+    {
+        emit(std::array<u8, 2>{ 0x80, 0x3D });
+        emitAddress(address);
+        code.push_back(value);
+    }
+
+    void CodeCave::cmpByte(Reg base, i8 disp, u8 value)
+    {
+        code.push_back(0x80);
+        emitModRm(0b01, 7, static_cast<u8>(base));
+        code.push_back(static_cast<u8>(disp));
+        code.push_back(value);
+    }
+
+    void CodeCave::lockInc(const void* address)
+    {
+        emit(std::array<u8, 3>{ 0xF0, 0xFF, 0x05 });
+        emitAddress(address);
+    }
+
+    void CodeCave::pushfd()
+    {
+        code.push_back(0x9C);
+    }
+
+    void CodeCave::popfd()
+    {
+        code.push_back(0x9D);
+    }
+
+    void CodeCave::push(Reg reg)
+    {
+        code.push_back(0x50 + static_cast<u8>(reg));
+    }
+
+    void CodeCave::pop(Reg reg)
+    {
+        code.push_back(0x58 + static_cast<u8>(reg));
+    }
+
+    void CodeCave::mov(Reg dst, const void* source)
+    {
+        code.push_back(0x8B);
+        emitModRm(0b00, static_cast<u8>(dst), 0b101);
+        emitAddress(source);
+    }
+
+    void CodeCave::mov(Reg dst, Reg base, i8 disp)
+    {
+        code.push_back(0x8B);
+        emitModRm(0b01, static_cast<u8>(dst), static_cast<u8>(base));
+        code.push_back(static_cast<u8>(disp));
+    }
+
+    void CodeCave::mov(Reg base, i8 disp, Reg src)
+    {
+        code.push_back(0x89);
+        emitModRm(0b01, static_cast<u8>(src), static_cast<u8>(base));
+        code.push_back(static_cast<u8>(disp));
+    }
+
+    void CodeCave::andImm(Reg reg, u32 value)
+    {
+        code.push_back(0x81);
+        emitModRm(0b11, 4, static_cast<u8>(reg));
+        emitImm(value);
+    }
+
+    void CodeCave::cmpImm(Reg reg, u32 value)
+    {
+        code.push_back(0x81);
+        emitModRm(0b11, 7, static_cast<u8>(reg));
+        emitImm(value);
+    }
+
+    size_t CodeCave::jne()
+    {
+        code.push_back(0x75);
+        code.push_back(0x00);
+        return code.size() - 2;
+    }
+
+    size_t CodeCave::je()
+    {
+        code.push_back(0x74);
+        code.push_back(0x00);
+        return code.size() - 2;
+    }
+
+    void CodeCave::bind(size_t jump)
+    {
+        code[jump + 1] = static_cast<u8>(static_cast<i8>(code.size() - (jump + 2)));
+    }
+
+    void CodeCave::emit(std::span<const u8> bytes)
+    {
+        code.insert(code.end(), bytes.begin(), bytes.end());
+    }
+
+    void CodeCave::emitAddress(const void* address)
+    {
+        emitImm(static_cast<u32>(reinterpret_cast<uintptr_t>(address)));
+    }
+
+    void CodeCave::emitImm(u32 value)
+    {
+        code.insert(code.end(), reinterpret_cast<const u8*>(&value), reinterpret_cast<const u8*>(&value) + sizeof(value));
+    }
+
+    void CodeCave::emitModRm(u8 mod, u8 reg, u8 rm)
+    {
+        code.push_back(static_cast<u8>((mod << 6) | (reg << 3) | rm));
+    }
+
+    bool CodeCave::install(uintptr_t site, const std::string& name)
+    {
+        Utils::TraceScope trace("CodeCave::install");
+        struct Displaced {
+            size_t offset;
+            size_t length;
+            bool branch;
+        };
+
+        ZydisDecoder decoder;
+        ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LEGACY_32, ZYDIS_STACK_WIDTH_32);
+
+        // Whole instructions covering the jump written over the site
+        auto bytes = reinterpret_cast<const u8*>(site);
+        std::vector<Displaced> displaced;
+        size_t length = 0;
+        while (length < jmpSize) {
+            ZydisDecodedInstruction instruction;
+            if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&decoder, ZYAN_NULL, bytes + length, 15, &instruction))) {
+                LOG("Failed to decode instruction @ {:x}", site + length);
+                return false;
+            }
+            bool branch = (bytes[length] == 0xE8 || bytes[length] == 0xE9) && instruction.length == jmpSize;
+            if ((instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE) && !branch) {
+                LOG("Can not relocate instruction @ {:x}", site + length);
+                return false;
+            }
+            displaced.push_back({ length, instruction.length, branch });
+            length += instruction.length;
+        }
+
+        u8* cave = allocateCave(code.size() + length + jmpSize);
+        if (cave == nullptr) {
+            LOG("Failed to allocate cave memory");
+            return false;
+        }
+        auto caveAddr = reinterpret_cast<uintptr_t>(cave);
+
+        // Emitted code, displaced instructions, jump back
+        std::vector<u8> body = code;
+        std::vector<std::pair<size_t, size_t>> moved;
+        for (const Displaced& instruction : displaced) {
+            moved.push_back({ instruction.offset, body.size() });
+            if (instruction.branch) {
+                i32 rel;
+                std::memcpy(&rel, bytes + instruction.offset + 1, sizeof(rel));
+                uintptr_t target = site + instruction.offset + jmpSize + rel;
+                emitRel32(body, bytes[instruction.offset], caveAddr + body.size(), target);
+            }
+            else {
+                body.insert(body.end(), bytes + instruction.offset, bytes + instruction.offset + instruction.length);
+            }
+        }
+        emitRel32(body, 0xE9, caveAddr + body.size(), site + length);
+        std::copy(body.begin(), body.end(), cave);
+        FlushInstructionCache(GetCurrentProcess(), cave, body.size());
+
+        std::vector<u8> detour;
+        emitRel32(detour, 0xE9, site, caveAddr);
+        detour.resize(length, 0x90);
+
+        // A thread on the site itself just takes the new jump
+        std::vector<std::pair<uintptr_t, uintptr_t>> moves;
+        for (auto& [from, to] : moved) {
+            if (from != 0) {
+                moves.push_back({ site + from, caveAddr + to });
+            }
+        }
+        if (Utils::HookTransaction* transaction = Utils::HookTransaction::current()) {
+            transaction->addPatch(name, site, std::move(detour), std::move(moves));
+            return true;
+        }
+        Utils::HookTransaction single(name);
+        single.addPatch(name, site, std::move(detour), std::move(moves));
+        return single.commit();
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <format>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+
+namespace
+{
+    std::string_view trim(std::string_view text)
+    {
+        size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    /**
+     * Cuts a `#` comment off a line, a `#` inside quotes or glued to a word is not a comment.
+     */
+    std::string_view stripComment(std::string_view line)
+    {
+        char quote = 0;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (quote != 0) {
+                quote = c == quote ? 0 : quote;
+            }
+            else if (c == '"' || c == '\'') {
+                quote = c;
+            }
+            else if (c == '#' && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t')) {
+                return line.substr(0, i);
+            }
+        }
+        return line;
+    }
+
+    std::string unquote(std::string_view value)
+    {
+        if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+            return std::string(value.substr(1, value.size() - 2));
+        }
+        return std::string(value);
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b)
+    {
+        return std::ranges::equal(a, b, [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+}
+
+namespace Utils
+{
+    bool Config::load(const std::string& path)
+    {
+        values.clear();
+        lastError.clear();
+
+        std::ifstream file(path);
+        if (!file) {
+            lastError = std::format("can not open {}", path);
+            return false;
+        }
+
+        // Keys of the maps the current line is nested in, with their indentation
+        std::vector<std::pair<size_t, std::string>> parents;
+        std::string line;
+        for (size_t number = 1; std::getline(file, line); ++number) {
+            std::string_view content = stripComment(line);
+            if (trim(content).empty()) {
+                continue;
+            }
+            size_t indent = content.find_first_not_of(' ');
+            if (content[indent] == '\t') {
+                lastError = std::format("line {}: tabs can not be used for indentation", number);
+                values.clear();
+                return false;
+            }
+
+            content = trim(content);
+            size_t colon = content.find(':');
+            while (colon != std::string_view::npos && colon + 1 < content.size() && content[colon + 1] != ' ') {
+                colon = content.find(':', colon + 1);
+            }
+            if (colon == std::string_view::npos || colon == 0) {
+                lastError = std::format("line {}: expected 'key: value'", number);
+                values.clear();
+                return false;
+            }
+
+            while (!parents.empty() && parents.back().first >= indent) {
+                parents.pop_back();
+            }
+            std::string key;
+            for (auto& [parentIndent, parentKey] : parents) {
+                key += parentKey + ".";
+            }
+            key += unquote(trim(content.substr(0, colon)));
+
+            std::string_view value = trim(content.substr(colon + 1));
+            if (value.empty()) {
+                parents.push_back({ indent, unquote(trim(content.substr(0, colon))) });
+            }
+            else {
+                values[key] = unquote(value);
+            }
+        }
+        return true;
+    }
+
+    const std::string& Config::error() const
+    {
+        return lastError;
+    }
+
+    bool Config::getBool(const std::string& key, bool fallback) const
+    {
+        auto it = values.find(key);
+        if (it == values.end()) {
+            return fallback;
+        }
+        for (std::string_view yes : { "true", "yes", "on" }) {
+            if (equalsIgnoreCase(it->second, yes)) {
+                return true;
+            }
+        }
+        for (std::string_view no : { "false", "no", "off" }) {
+            if (equalsIgnoreCase(it->second, no)) {
+                return false;
+            }
+        }
+        LOG("Config '{}' is not a boolean: '{}', using {}", key, it->second, fallback);
+        return fallback;
+    }
+
+    u32 Config::getU32(const std::string& key, u32 fallback) const
+    {
+        auto it = values.find(key);
+        if (it == values.end()) {
+            return fallback;
+        }
+        u32 value = 0;
+        const char* begin = it->second.data();
+        const char* end = begin + it->second.size();
+        auto [ptr, ec] = std::from_chars(begin, end, value);
+        if (ec != std::errc() || ptr != end) {
+            LOG("Config '{}' is not an unsigned integer: '{}', using {}", key, it->second, fallback);
+            return fallback;
+        }
+        return value;
+    }
+
+    std::string Config::getString(const std::string& key, const std::string& fallback) const
+    {
+        auto it = values.find(key);
+        return it == values.end() ? fallback : it->second;
+    }
+}
@@ -36,60 +36,248 @@
 #include <cmath>
 #include <cstdint>
 #include <algorithm>
+#include <array>
 #include <bit>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <string_view>
+#include <chrono>
+#include <dxgi.h>
+#include <dshow.h>
 
 // Local includes
 #include "utils.hpp"
+#include "handlecache.hpp"
+#include "archivereader.hpp"
+#include "readtrace.hpp"
+#include "framepacer.hpp"
+#include "telemetry.hpp"
+#include "threadmanager.hpp"
+#include "moviestate.hpp"
+#include "moviegraph.hpp"
+#include "codecave.hpp"
+#include "snapshot.hpp"
+#include "config.hpp"
+#include "trace.hpp"
+#include "signatures.hpp"
+
+// 3rd party includes
+#include "spdlog/async.h"
 
 // Macros
 #define VERSION "1.0.1"
+#define FIX_OFFSET(member) static_cast<i8>(offsetof(fixConstants_t, member))
 
 // .yml to struct
 typedef struct resolution_t {
     u32 width;
     u32 height;
     f32 aspectRatio;
+    bool desktop;
 } resolution_t;
 
 typedef struct constrainHud_t {
     bool enable;
 } constrainHud_t;
 
+typedef struct earlyInject_t {
+    bool enable;
+} earlyInject_t;
+
+typedef struct hotReload_t {
+    bool enable;
+} hotReload_t;
+
+typedef struct archiveMapping_t {
+    bool enable;
+} archiveMapping_t;
+
+typedef struct readPrefetch_t {
+    bool enable;
+    u32 recordSeconds;
+} readPrefetch_t;
+
+typedef struct telemetry_t {
+    bool enable;
+    u32 hotkey;
+} telemetry_t;
+
+typedef struct threadRule_t {
+    std::string priority;
+    std::string cores;
+    std::string qos;
+} threadRule_t;
+
+typedef struct threads_t {
+    bool enable;
+    threadRule_t render;
+    threadRule_t streaming;
+    threadRule_t movie;
+    threadRule_t worker;
+} threads_t;
+
 typedef struct features_t {
     constrainHud_t constrainHud;
+    earlyInject_t earlyInject;
+    hotReload_t hotReload;
+    archiveMapping_t archiveMapping;
+    readPrefetch_t readPrefetch;
+    telemetry_t telemetry;
+    threads_t threads;
 } features_t;
 
+typedef struct scanner_t {
+    u32 threads;
+} scanner_t;
+
+typedef struct movies_t {
+    std::string detection;
+    u32 hysteresis;
+} movies_t;
+
+typedef struct framerate_t {
+    u32 target;
+    bool unlock;
+} framerate_t;
+
+typedef struct logging_t {
+    std::string level;
+    u32 flushIntervalMs;
+    bool startupTrace;
+} logging_t;
+
+// Fix registry, see fixes
+enum class fixStage_t : u8 {
+    Early,
+    Hooks,
+    Late,
+};
+
+typedef struct fix_t {
+    const char* name;
+    fixStage_t stage;
+    Utils::SignatureHook* signature;
+    void (*apply)();
+    bool (*enabled)();
+} fix_t;
+
+// Values derived from the .yml, read by the hooks and code caves through the current snapshot
+typedef struct alignas(64) fixConstants_t {
+    f32 aspectRatio;
+    f32 width;
+    f32 hudScale;
+    f32 hudOffset;
+    f32 nativeWidth;
+    f32 nativeOffset;
+    f32 widthScalingFactor;
+    bool hudEnable;
+    bool unlockFramerate;
+    u32 targetFps;
+} fixConstants_t;
+static_assert(sizeof(fixConstants_t) == 64, "fixConstants_t must fill exactly one cache line");
+
+// Native resolution patch left for the next launch, read by DllMain as is, see nativeResolutionFix
+typedef struct earlyRecord_t {
+    u32 magic;
+    u32 timeDateStamp;
+    u32 sizeOfImage;
+    u32 rva;
+    u32 width;
+    u32 height;
+} earlyRecord_t;
+
 typedef struct yml_t {
     std::string name;
     bool masterEnable;
     resolution_t resolution;
+    scanner_t scanner;
+    movies_t movies;
+    framerate_t framerate;
+    logging_t logging;
     features_t feature;
 } yml_t;
 
 // Globals
 Utils::ModuleInfo module(GetModuleHandle(nullptr));
 
-u32 nativeWidth = 0;
-u32 nativeOffset = 0;
 f32 nativeAspectRatio = (16.0f / 9.0f);
-f32 widthScalingFactor = 0;
 
 SafetyHookInline readFileHook{};
-bool isMoviePlaying = false;
+SafetyHookInline closeHandleHook{};
+SafetyHookInline presentHook{};
+SafetyHookInline graphRunHook{};
+SafetyHookInline graphStopHook{};
+SafetyHookInline graphEventHook{};
+Utils::HandleCache handleCache;
+Utils::ArchiveReader archiveReader;
+Utils::MovieState movieState;
+Utils::FramePacer framePacer;
+Utils::FrameTelemetry telemetry;
+Utils::ThreadManager threadManager;
 
-YAML::Node config = YAML::LoadFile("GodEater1-2Fix.yml");
+// Identity of the filter graph playing the current movie, see moviesFix
+std::atomic<const void*> movieGraph = nullptr;
+// Movies are inferred from ReadFile, the graph hooks are disabled or could not be installed
+bool movieReads = false;
+
+// Runs of the HUD code cave since the last present, counted while telemetry is enabled
+std::atomic<u32> hudHits = 0;
+
+// Folder the mod was loaded from, set in DllMain, see modFile
+std::filesystem::path modFolder;
+constexpr const char* configName = "GodEater1-2Fix.yml";
+constexpr const char* earlyName = "GodEater1-2Fix.early";
+constexpr u32 earlyMagic = 0x31454547; // 'GEE1'
 yml_t yml;
+Utils::SnapshotRing<fixConstants_t> fix;
+
+bool nativeResolutionPatched = false;
+// Result of committing the hooks stage, a hook that was created but rolled back still converts to true
+bool hooksCommitted = false;
+// Record `earlyPatch` applied from DllMain, all zero if it did not patch
+earlyRecord_t earlyPatched = {};
+
+// Hook stats ids, see Utils::HookStats
+u32 readFileStats = 0;
+u32 closeHandleStats = 0;
+
+// Allocation audit ids, see Utils::AllocAudit
+u32 readFileAllocs = 0;
+u32 closeHandleAllocs = 0;
+u32 presentAllocs = 0;
+
+/**
+ * @brief Path of one of the mod's own files.
+ *
+ * @details Everything the mod reads or writes lives next to the mod itself, the working directory is
+ * not necessarily the game folder. Falls back to the working directory if the mod's folder is unknown.
+ *
+ * @param name File name.
+ * @return std::filesystem::path Path of the file in `modFolder`.
+ */
+std::filesystem::path modFile(std::string_view name) {
+    return modFolder / name;
+}
 
 /**
  * @brief Initializes logging for the application.
  *
+ * @details
+ * Lines are queued into a bounded ring buffer and written to disk by spdlog's own worker thread, the
+ * thread logging never waits on the file. When the buffer is full the oldest queued line is dropped
+ * rather than blocking. Errors are flushed right away, everything else on the interval set with
+ * `applyLogging` once the config is read.
+ *
  * @return void
  */
 void logInit() {
     // spdlog initialisation
-    auto logger = spdlog::basic_logger_mt("GodEater1-2Fix", "GodEater1-2Fix.log", true);
+    spdlog::init_thread_pool(8192, 1);
+    auto logger = spdlog::create_async_nb<spdlog::sinks::basic_file_sink_mt>("GodEater1-2Fix", modFile("GodEater1-2Fix.log").string(), true);
     spdlog::set_default_logger(logger);
-    spdlog::flush_on(spdlog::level::debug);
+    spdlog::flush_on(spdlog::level::err);
 
     // Get game name and exe path
     WCHAR exePath[_MAX_PATH] = { 0 };
@@ -108,29 +296,138 @@ void logInit() {
 }
 
 /**
- * @brief Reads and parses configuration settings from a YAML file.
+ * @brief Parses configuration settings from a YAML document.
  *
- * @return void
+ * @details Missing or malformed values fall back to the defaults of the shipped GodEater1-2Fix.yml.
+ *
+ * @param node The parsed GodEater1-2Fix.yml.
+ * @return yml_t with a resolution of 0 replaced by the desktop's resolution.
  */
-void readYml() {
-    yml.name = config["name"].as<std::string>();
+yml_t parseYml(const Utils::Config& node) {
+    yml_t parsed;
+    parsed.name = node.getString("name", "God Eater 1-2 Fix");
+
+    parsed.masterEnable = node.getBool("masterEnable", true);
+
+    parsed.resolution.width = node.getU32("resolution.width", 0);
+    parsed.resolution.height = node.getU32("resolution.height", 0);
+
+    parsed.scanner.threads = node.getU32("scanner.threads", 0);
+
+    parsed.movies.detection = node.getString("movies.detection", "graph");
+    parsed.movies.hysteresis = node.getU32("movies.hysteresis", 1);
 
-    yml.masterEnable = config["masterEnable"].as<bool>();
+    parsed.framerate.target = node.getU32("framerate.target", 0);
+    parsed.framerate.unlock = node.getBool("framerate.unlock", false);
 
-    yml.resolution.width = config["resolution"]["width"].as<u32>();
-    yml.resolution.height = config["resolution"]["height"].as<u32>();
+    parsed.logging.level = node.getString("logging.level", "info");
+    parsed.logging.flushIntervalMs = node.getU32("logging.flushIntervalMs", 1000);
+    parsed.logging.startupTrace = node.getBool("logging.startupTrace", false);
 
-    yml.feature.constrainHud.enable = config["features"]["constrainHud"]["enable"].as<bool>();
+    parsed.feature.constrainHud.enable = node.getBool("features.constrainHud.enable", false);
+    parsed.feature.earlyInject.enable = node.getBool("features.earlyInject.enable", false);
+    parsed.feature.hotReload.enable = node.getBool("features.hotReload.enable", false);
+    parsed.feature.archiveMapping.enable = node.getBool("features.archiveMapping.enable", false);
+    parsed.feature.readPrefetch.enable = node.getBool("features.readPrefetch.enable", false);
+    parsed.feature.readPrefetch.recordSeconds = node.getU32("features.readPrefetch.recordSeconds", 180);
+    parsed.feature.telemetry.enable = node.getBool("features.telemetry.enable", false);
+    parsed.feature.telemetry.hotkey = node.getU32("features.telemetry.hotkey", VK_F10);
+    parsed.feature.threads.enable = node.getBool("features.threads.enable", false);
+    auto parseThreadRule = [&node](const std::string& role) {
+        std::string key = "features.threads." + role;
+        return threadRule_t{
+            node.getString(key + ".priority", "unchanged"),
+            node.getString(key + ".cores", "unchanged"),
+            node.getString(key + ".qos", "unchanged"),
+        };
+    };
+    parsed.feature.threads.render = parseThreadRule("render");
+    parsed.feature.threads.streaming = parseThreadRule("streaming");
+    parsed.feature.threads.movie = parseThreadRule("movie");
+    parsed.feature.threads.worker = parseThreadRule("worker");
 
-    if (yml.resolution.width == 0 || yml.resolution.height == 0) {
+    parsed.resolution.desktop = parsed.resolution.width == 0 || parsed.resolution.height == 0;
+    if (parsed.resolution.desktop) {
         std::pair<int, int> dimensions = Utils::getDesktopDimensions();
-        yml.resolution.width  = dimensions.first;
-        yml.resolution.height = dimensions.second;
+        parsed.resolution.width  = dimensions.first;
+        parsed.resolution.height = dimensions.second;
     }
-    yml.resolution.aspectRatio = static_cast<f32>(yml.resolution.width) / static_cast<f32>(yml.resolution.height);
-    nativeWidth = (16.0f / 9.0f) * static_cast<f32>(yml.resolution.height);
-    nativeOffset = static_cast<f32>(yml.resolution.width - nativeWidth) / 2.0f;
-    widthScalingFactor = static_cast<f32>(yml.resolution.width) / static_cast<f32>(nativeWidth);
+    parsed.resolution.aspectRatio = static_cast<f32>(parsed.resolution.width) / static_cast<f32>(parsed.resolution.height);
+    return parsed;
+}
+
+/**
+ * @brief Computes everything the hooks need from the config, so nothing is derived per call.
+ *
+ * @param settings Parsed config.
+ * @return fixConstants_t to publish.
+ */
+fixConstants_t deriveConstants(const yml_t& settings) {
+    u32 nativeWidth = (16.0f / 9.0f) * static_cast<f32>(settings.resolution.height);
+    u32 nativeOffset = static_cast<f32>(settings.resolution.width - nativeWidth) / 2.0f;
+    f32 ratio = static_cast<f32>(nativeWidth) / static_cast<f32>(settings.resolution.width);
+
+    fixConstants_t constants = {};
+    constants.aspectRatio = settings.resolution.aspectRatio;
+    constants.width = static_cast<f32>(settings.resolution.width);
+    constants.hudScale = (2.0f / static_cast<f32>(settings.resolution.width)) * ratio;
+    constants.hudOffset = ratio * -1.0f;
+    constants.nativeWidth = static_cast<f32>(nativeWidth);
+    constants.nativeOffset = static_cast<f32>(nativeOffset);
+    constants.widthScalingFactor = static_cast<f32>(settings.resolution.width) / static_cast<f32>(nativeWidth);
+    constants.hudEnable = settings.feature.constrainHud.enable;
+    constants.unlockFramerate = settings.framerate.unlock;
+    constants.targetFps = settings.framerate.target;
+    return constants;
+}
+
+/**
+ * @brief Applies the logging settings of the config.
+ *
+ * @details An unknown level keeps logging at info. A flush interval of 0 flushes after every line,
+ * this still happens on spdlog's worker thread.
+ *
+ * @param logging Logging settings to apply.
+ * @return void
+ */
+void applyLogging(const logging_t& logging) {
+    spdlog::level::level_enum level = spdlog::level::from_str(logging.level);
+    if (level == spdlog::level::off && logging.level != "off") {
+        LOG("Unknown log level '{}', using info", logging.level);
+        level = spdlog::level::info;
+    }
+    spdlog::set_level(level);
+
+    if (logging.flushIntervalMs == 0) {
+        spdlog::flush_on(spdlog::level::trace);
+    }
+    else {
+        spdlog::flush_on(spdlog::level::err);
+        spdlog::flush_every(std::chrono::milliseconds(logging.flushIntervalMs));
+    }
+}
+
+/**
+ * @brief Reads and parses configuration settings from a YAML file.
+ *
+ * @details
+ * This runs on the `Main` thread, not during static initialization, so nothing is read while the loader
+ * lock is held. A config that can not be read or parsed is logged and the
+ * defaults are used.
+ *
+ * @return void
+ */
+void readYml() {
+    std::string configPath = modFile(configName).string();
+    Utils::Config config;
+    if (!config.load(configPath)) {
+        LOG("Failed to load {}: {}, using defaults", configPath, config.error());
+    }
+    yml = parseYml(config);
+    applyLogging(yml.logging);
+    movieState.setHysteresis(yml.movies.hysteresis);
+    fix.publish(deriveConstants(yml));
+    const fixConstants_t* constants = fix.current();
 
     // Get that info!
     LOG("Name: {}", yml.name);
@@ -138,9 +435,247 @@ void readYml() {
     LOG("Resolution.Width: {}", yml.resolution.width);
     LOG("Resolution.Height: {}", yml.resolution.height);
     LOG("Resolution.AspectRatio: {}", yml.resolution.aspectRatio);
-    LOG("Normalized Width: {}", nativeWidth);
-    LOG("Normalized Offset: {}", nativeOffset);
-    LOG("Width Scaling Factor: {}", widthScalingFactor);
+    LOG("Scanner.Threads: {}", yml.scanner.threads);
+    LOG("Movies.Detection: {}", yml.movies.detection);
+    LOG("Movies.Hysteresis: {}", yml.movies.hysteresis);
+    LOG("Framerate.Target: {}", yml.framerate.target);
+    LOG("Framerate.Unlock: {}", yml.framerate.unlock);
+    LOG("Logging.Level: {}", yml.logging.level);
+    LOG("Logging.FlushIntervalMs: {}", yml.logging.flushIntervalMs);
+    LOG("Logging.StartupTrace: {}", yml.logging.startupTrace);
+    LOG("EarlyInject.Enable: {}", yml.feature.earlyInject.enable);
+    LOG("HotReload.Enable: {}", yml.feature.hotReload.enable);
+    LOG("ArchiveMapping.Enable: {}", yml.feature.archiveMapping.enable);
+    LOG("ReadPrefetch.Enable: {}", yml.feature.readPrefetch.enable);
+    LOG("ReadPrefetch.RecordSeconds: {}", yml.feature.readPrefetch.recordSeconds);
+    LOG("Telemetry.Enable: {}", yml.feature.telemetry.enable);
+    LOG("Telemetry.Hotkey: {}", yml.feature.telemetry.hotkey);
+    LOG("Threads.Enable: {}", yml.feature.threads.enable);
+    LOG("Threads.Render: {} {} {}", yml.feature.threads.render.priority, yml.feature.threads.render.cores, yml.feature.threads.render.qos);
+    LOG("Threads.Streaming: {} {} {}", yml.feature.threads.streaming.priority, yml.feature.threads.streaming.cores, yml.feature.threads.streaming.qos);
+    LOG("Threads.Movie: {} {} {}", yml.feature.threads.movie.priority, yml.feature.threads.movie.cores, yml.feature.threads.movie.qos);
+    LOG("Threads.Worker: {} {} {}", yml.feature.threads.worker.priority, yml.feature.threads.worker.cores, yml.feature.threads.worker.qos);
+    LOG("Normalized Width: {}", constants->nativeWidth);
+    LOG("Normalized Offset: {}", constants->nativeOffset);
+    LOG("Width Scaling Factor: {}", constants->widthScalingFactor);
+}
+
+/**
+ * @brief Re-reads GodEater1-2Fix.yml and publishes the new constants to the hooks.
+ *
+ * @details
+ * Only the resolution, constrainHud, movies.hysteresis, framerate and logging take effect, everything else decides which
+ * hooks get installed and needs a restart. A config that fails to parse is logged and ignored, the
+ * hooks keep the previous constants.
+ *
+ * @return void
+ */
+void reloadYml() {
+    std::string configPath = modFile(configName).string();
+    Utils::Config config;
+    if (!config.load(configPath)) {
+        LOG("Failed to reload {}: {}", configPath, config.error());
+        return;
+    }
+    yml_t reloaded = parseYml(config);
+    applyLogging(reloaded.logging);
+    movieState.setHysteresis(reloaded.movies.hysteresis);
+    fix.publish(deriveConstants(reloaded));
+    LOG("Reloaded {} (epoch {}): {}x{}, ConstrainHud: {}, Movies.Hysteresis: {}, Framerate: {} {}",
+        configPath, fix.epoch(), reloaded.resolution.width, reloaded.resolution.height,
+        reloaded.feature.constrainHud.enable, reloaded.movies.hysteresis,
+        reloaded.framerate.target, reloaded.framerate.unlock ? "unlocked" : "vsync");
+}
+
+/**
+ * @brief Watches the mod's folder and reloads the config whenever GodEater1-2Fix.yml changes.
+ *
+ * @details
+ * Editors tend to write a file in several steps, so after a change the watcher waits a moment for the
+ * writes to settle and coalesces everything that arrives in the meantime into one reload. This also
+ * keeps reloads far apart, which the grace period of `Utils::SnapshotRing` relies on.
+ *
+ * @param lpParameter Unused parameter.
+ * @return DWORD 0 once the folder can no longer be watched.
+ */
+DWORD WINAPI configWatcher(void* lpParameter) {
+    constexpr DWORD settleMs = 250;
+    constexpr std::wstring_view fileName = L"GodEater1-2Fix.yml";
+    std::string configPath = modFile(configName).string();
+
+    HANDLE directory = CreateFileW(modFolder.empty() ? L"." : modFolder.wstring().c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (directory == INVALID_HANDLE_VALUE) {
+        LOG("Failed to watch for changes to {}", configPath);
+        return 0;
+    }
+    LOG("Watching {} for changes", configPath);
+
+    alignas(DWORD) u8 buffer[4096];
+    DWORD bytesReturned = 0;
+    while (ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, &bytesReturned, nullptr, nullptr)) {
+        // 0 bytes means the buffer overflowed, the config may have changed so reload anyway
+        bool changed = bytesReturned == 0;
+        for (size_t offset = 0; offset < bytesReturned && !changed;) {
+            auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            std::wstring_view name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            changed = CompareStringOrdinal(name.data(), static_cast<int>(name.size()),
+                fileName.data(), static_cast<int>(fileName.size()), TRUE) == CSTR_EQUAL;
+            if (info->NextEntryOffset == 0) {
+                break;
+            }
+            offset += info->NextEntryOffset;
+        }
+        if (changed) {
+            Sleep(settleMs);
+            reloadYml();
+        }
+    }
+    LOG("Stopped watching {}", configPath);
+    CloseHandle(directory);
+    return 0;
+}
+
+/**
+ * @brief Starts the config watcher.
+ *
+ * @return void
+ */
+void hotReloadFix() {
+    HANDLE watcherHandle = CreateThread(nullptr, 0, configWatcher, nullptr, 0, nullptr);
+    if (watcherHandle) {
+        SetThreadPriority(watcherHandle, THREAD_PRIORITY_LOWEST);
+        CloseHandle(watcherHandle);
+    }
+}
+
+/**
+ * @brief Runs one phase of the startup and records it in the startup trace.
+ *
+ * @param name Name of the phase on the timeline.
+ * @param phase Function to run.
+ * @return void
+ */
+void runPhase(const char* name, void (*phase)()) {
+    Utils::TraceScope trace(name);
+    phase();
+}
+
+/**
+ * @brief Initializes logging and reads the config.
+ *
+ * @return void
+ */
+void init() {
+    runPhase("logInit", logInit);
+    runPhase("readYml", readYml);
+}
+
+/**
+ * @brief Patches the native resolution from `DllMain`, before the game reads it.
+ *
+ * @details
+ * Runs with the loader lock held, so neither the config nor the logger is touched. Only the fixed size
+ * record `nativeResolutionFix` left behind is read, and it is only applied if it was written for the
+ * running exe build and the bytes at its RVA are still the native resolution. `nativeResolutionFix`
+ * logs the outcome from `Main`.
+ *
+ * @return void
+ */
+void earlyPatch() {
+    HANDLE file = CreateFileW(modFile(earlyName).wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    earlyRecord_t record = {};
+    DWORD bytesRead = 0;
+    BOOL read = ReadFile(file, &record, sizeof(record), &bytesRead, nullptr);
+    CloseHandle(file);
+
+    const Utils::Signature& native = nativeResolutionSignature.signature;
+    if (!read || bytesRead != sizeof(record) || record.magic != earlyMagic ||
+        record.timeDateStamp != module.timeDateStamp || record.sizeOfImage != module.sizeOfImage ||
+        record.rva > module.sizeOfImage - native.size) {
+        return;
+    }
+    u64 absAddr = reinterpret_cast<u64>(module.address) + record.rva;
+    if (!std::equal(native.bytes.begin(), native.bytes.begin() + native.size, reinterpret_cast<const u8*>(absAddr))) {
+        return;
+    }
+    std::array<u8, 8> resolution = {};
+    std::memcpy(&resolution[0], &record.width, sizeof(u32));
+    std::memcpy(&resolution[4], &record.height, sizeof(u32));
+    Utils::patch(absAddr, resolution);
+    earlyPatched = record;
+}
+
+/**
+ * @brief Patches the native resolution the game computes its aspect ratio from.
+ *
+ * @details
+ * The game reads its native resolution of 1920x1080, '80 07 00 00 38 04 00 00', once at startup to
+ * compute the aspect ratio, see `aspectRatioFix`. When the mod is loaded before that happens the constant
+ * is overwritten with the desired resolution and the game computes the right aspect ratio on its own,
+ * which makes the per-frame hook of `aspectRatioFix` unnecessary.
+ *
+ * The ASI loader loads the mod while the game's CRT is still starting up, so only `DllMain` runs before
+ * the game's own code, with the loader lock held. Parsing the config there is off the table, instead this
+ * runs from `Main` and writes GodEater1-2Fix.early with the exe build, the RVA of the native resolution
+ * and the resolution to patch it with, which `earlyPatch` applies on the next launch. The first launch
+ * after enabling earlyInject, changing the resolution or updating the game is left to `aspectRatioFix`.
+ * The logger, spdlog's thread pool and the desktop resolution lookup through user32 all wait for `Main`.
+ * The desktop resolution also can not be known before the config is read, so only a resolution set in
+ * the config is recorded, with a width or height of 0 the record is removed and nothing is patched.
+ *
+ * The pattern is only 8 bytes of plain data, nothing ties it to the aspect ratio code. It is only
+ * recorded when `.data` holds exactly one copy of it, otherwise this could overwrite some unrelated
+ * 1920x1080 and the record is removed, which leaves `aspectRatioFix` to do the job.
+ *
+ * @return void
+ */
+void nativeResolutionFix() {
+    if (yml.resolution.desktop) {
+        LOG("Native resolution needs an explicit resolution, not patching, aspectRatioFix stays enabled");
+        std::error_code error;
+        std::filesystem::remove(modFile(earlyName), error);
+        return;
+    }
+    earlyRecord_t record = earlyPatched;
+    if (record.magic == earlyMagic) {
+        LOG("Patched native resolution @ {:s}+{:x} to {}x{} from DllMain", module.name, record.rva, record.width, record.height);
+        nativeResolutionPatched = record.width == yml.resolution.width && record.height == yml.resolution.height;
+        if (!nativeResolutionPatched) {
+            LOG("Resolution changed to {}x{}, aspectRatioFix stays enabled", yml.resolution.width, yml.resolution.height);
+        }
+    }
+    else {
+        // The patched bytes no longer match the signature, so only scan when DllMain did not patch
+        Utils::loadSignatureCache(module, modFile("GodEater1-2Fix.cache").string());
+        Utils::SignatureHook* hooks[] = { &nativeResolutionSignature };
+        Utils::resolveSignatures(module, hooks);
+        size_t hits = nativeResolutionSignature.hits.size();
+        if (hits != 1) {
+            LOG("Native resolution has {} hits, not patching, aspectRatioFix stays enabled", hits);
+            std::error_code error;
+            std::filesystem::remove(modFile(earlyName), error);
+            return;
+        }
+        record.magic = earlyMagic;
+        record.timeDateStamp = module.timeDateStamp;
+        record.sizeOfImage = module.sizeOfImage;
+        record.rva = static_cast<u32>(nativeResolutionSignature.hits.front() - reinterpret_cast<uintptr_t>(module.address));
+    }
+    record.width = yml.resolution.width;
+    record.height = yml.resolution.height;
+
+    std::ofstream file(modFile(earlyName), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    if (!file) {
+        LOG("Failed to write {}", earlyName);
+        return;
+    }
+    LOG("Native resolution @ {:s}+{:x} is patched to {}x{} from DllMain on the next launch", module.name, record.rva, record.width, record.height);
 }
 
 /**
@@ -196,15 +731,27 @@ void readYml() {
  * A hook is placed on line 1, where the xmm0 is written to memory, where we inject the desired aspect
  * ratio value. And now in game the game is correctly rendering the area that it should be.
  *
+ * This runs every 3D frame, so instead of a mid hook a code cave loads the aspect ratio of the current
+ * `fix` snapshot into xmm0 right before the displaced write:
+ *     push ecx
+ *     mov ecx, dword ptr ds:[fix]
+ *     movss xmm0, dword ptr [ecx+aspectRatio]
+ *     pop ecx
+ *     movss dword ptr ds:[16FF234], xmm0
+ *
+ * With earlyInject enabled `nativeResolutionFix` already patched the source of the aspect ratio and the
+ * hook is skipped.
+ *
  * @return void
  */
 void aspectRatioFix() {
-    Utils::SignatureHook hook("F3 0F 11 05 ?? ?? ?? ??    E8 ?? ?? ?? ??    89 EC");
-
-    bool enable = yml.masterEnable;
-    Utils::injectHook(enable, module, hook,
-        [](SafetyHookContext& ctx) {
-            ctx.xmm0.f32[0] = yml.resolution.aspectRatio;
+    Utils::injectCave(true, module, aspectRatioSignature,
+        [](Utils::CodeCave& cave) {
+            using Reg = Utils::CodeCave::Reg;
+            cave.push(Reg::ecx);
+            cave.mov(Reg::ecx, fix.currentAddress());
+            cave.movssXmm0(Reg::ecx, FIX_OFFSET(aspectRatio));
+            cave.pop(Reg::ecx);
         }
     );
 }
@@ -223,20 +770,37 @@ void aspectRatioFix() {
  * lost knowledge at this point even with trying to retrace from this point backwards. On the brightside
  * it works though!!!
  *
+ * The width overridden here sizes the output, not the 3D scene on its own. The scene, post processing
+ * and HUD are all drawn at this width, so a lower value shrinks the HUD along with the scene and also
+ * squeezes the picture horizontally instead of scaling it. A render scale that keeps the HUD native
+ * needs the place where the engine creates its scene render targets, which none of the signatures in
+ * signatures.hpp reach. Resizing the swap chain behind the game's back does not work either, the
+ * game's viewports and render targets keep the size it created them with.
+ *
+ * This runs every frame, so instead of a mid hook a code cave overrides the width in xmm0 before the
+ * displaced call, unless a movie is playing:
+ *     cmp byte ptr ds:[movieState], 0
+ *     jne skip
+ *     push ecx
+ *     mov ecx, dword ptr ds:[fix]
+ *     movss xmm0, dword ptr [ecx+width]
+ *     pop ecx
+ *   skip:
+ *     call ...
+ *
  * @return void
  */
 void resolutionFix() {
-    Utils::SignatureHook hook(
-        "76 ??    F3 0F 59 05 ?? ?? ?? ??    F3 0F 5E 05 ?? ?? ?? ??    E8 ?? ?? ?? ??",
-        18
-    );
-
-    bool enable = yml.masterEnable;
-    Utils::injectHook(enable, module, hook,
-        [](SafetyHookContext& ctx) {
-            if (isMoviePlaying == false) {
-                ctx.xmm0.f32[0] = static_cast<float>(yml.resolution.width);
-            }
+    Utils::injectCave(true, module, resolutionSignature,
+        [](Utils::CodeCave& cave) {
+            using Reg = Utils::CodeCave::Reg;
+            cave.cmpByte(movieState.playingAddress(), 0);
+            size_t skip = cave.jne();
+            cave.push(Reg::ecx);
+            cave.mov(Reg::ecx, fix.currentAddress());
+            cave.movssXmm0(Reg::ecx, FIX_OFFSET(width));
+            cave.pop(Reg::ecx);
+            cave.bind(skip);
         }
     );
 }
@@ -300,21 +864,75 @@ void resolutionFix() {
  *                                 in the mod and you can see
  *                                 where that comes from
  *
+ * The hooked instruction is a generic 16 byte copy that runs for every transform the game copies, most
+ * of which are not UI. A code cave does the test and the two writes itself, touching only ecx, edx and
+ * the flags which are saved around it. With hotReload enabled the cave is installed even if constrainHud
+ * is off, the hudEnable byte of the current `fix` snapshot turns it on and off:
+ *     pushfd
+ *     push ecx
+ *     push edx
+ *     mov edx, dword ptr ds:[fix]
+ *     cmp byte ptr [edx+hudEnable], 0
+ *     je skip
+ *     mov ecx, dword ptr [eax+30]
+ *     and ecx, BF000000
+ *     cmp ecx, BF000000
+ *     jne skip
+ *     mov ecx, dword ptr [eax+3C]
+ *     and ecx, 3F000000
+ *     cmp ecx, 3F000000
+ *     jne skip
+ *     mov ecx, dword ptr [edx+hudScale]
+ *     mov dword ptr [eax+00], ecx
+ *     mov ecx, dword ptr [edx+hudOffset]
+ *     mov dword ptr [eax+30], ecx
+ *   skip:
+ *     pop edx
+ *     pop ecx
+ *     popfd
+ *
+ * Why are shadow map size and draw distance not options the same way?
+ * Neither has been found in either exe yet. The HUD had a copy instruction to trace back from and the
+ * native resolution had 1920x1080 to search for, but a shadow map size such as 2048 is a value half
+ * the engine uses elsewhere, and draw distance is not known to be a single constant rather than a
+ * per-object table. Signatures are compiled in, so each knob needs a pattern that `GodEater1-2Fix-sigbench`
+ * finds exactly once in both GER.exe and GE2RB.exe. An option shipped before that would either do
+ * nothing or patch the wrong bytes. Once found, the signature goes in signatures.hpp, the patch goes
+ * through `Utils::patch` like `nativeResolutionFix` and it gets its own entry in `fixes`.
+ *
  * @return void
  */
 void hudElementsFix() {
-    Utils::SignatureHook hook("F3 0F 6F 00    F3 0F 7F 41 0C    F3 0F 6F 40 10");
-
-    bool enable = yml.masterEnable && yml.feature.constrainHud.enable;
-    Utils::injectHook(enable, module, hook,
-        [](SafetyHookContext& ctx) {
-            u32 scaler0 = *reinterpret_cast<u32*>(ctx.eax + 0x30);
-            u32 scaler1 = *reinterpret_cast<u32*>(ctx.eax + 0x3C);
-            if (((scaler0 & 0xBF000000) == 0xBF000000) && ((scaler1 & 0x3F000000) == 0x3F000000)) {
-                f32 ratio = static_cast<f32>(nativeWidth) / static_cast<f32>(yml.resolution.width);
-                *reinterpret_cast<f32*>(ctx.eax + 0x00) = (2.0f / static_cast<f32>(yml.resolution.width)) * ratio;
-                *reinterpret_cast<f32*>(ctx.eax + 0x30) = ratio * -1.0f;
+    Utils::injectCave(true, module, hudElementsSignature,
+        [](Utils::CodeCave& cave) {
+            using Reg = Utils::CodeCave::Reg;
+            cave.pushfd();
+            if (yml.feature.telemetry.enable) {
+                cave.lockInc(&hudHits);
             }
+            cave.push(Reg::ecx);
+            cave.push(Reg::edx);
+            cave.mov(Reg::edx, fix.currentAddress());
+            cave.cmpByte(Reg::edx, FIX_OFFSET(hudEnable), 0);
+            size_t disabled = cave.je();
+            cave.mov(Reg::ecx, Reg::eax, 0x30);
+            cave.andImm(Reg::ecx, 0xBF000000);
+            cave.cmpImm(Reg::ecx, 0xBF000000);
+            size_t notScaler0 = cave.jne();
+            cave.mov(Reg::ecx, Reg::eax, 0x3C);
+            cave.andImm(Reg::ecx, 0x3F000000);
+            cave.cmpImm(Reg::ecx, 0x3F000000);
+            size_t notScaler1 = cave.jne();
+            cave.mov(Reg::ecx, Reg::edx, FIX_OFFSET(hudScale));
+            cave.mov(Reg::eax, 0x00, Reg::ecx);
+            cave.mov(Reg::ecx, Reg::edx, FIX_OFFSET(hudOffset));
+            cave.mov(Reg::eax, 0x30, Reg::ecx);
+            cave.bind(disabled);
+            cave.bind(notScaler0);
+            cave.bind(notScaler1);
+            cave.pop(Reg::edx);
+            cave.pop(Reg::ecx);
+            cave.popfd();
         }
     );
 }
@@ -325,9 +943,21 @@ void hudElementsFix() {
  * @details
  * The hook is placed on the ReadFile function of the kernel32.dll.
  * The hook intercepts the ReadFile call and checks the file path and if the file has a .wmv extension
- * then the isMoviePlaying variable is set to true.
+ * then playback is signalled through movieState, reads of other files end it. This is only done when
+ * movies are detected from reads, see `moviesFix`.
  * None of the input parameters are dirtied, only hFile is read to determine the file extension.
  *
+ * Every handle is classified once, the first time it is read from, and the result is kept in a
+ * lock-free table until the handle is closed. The common path is a single table lookup with no
+ * syscalls and no allocations.
+ *
+ * With archiveMapping enabled synchronous reads of the .qpck archives are copied out of mapped views
+ * by `Utils::ArchiveReader` instead, which moves the file pointer and reports the bytes read the same
+ * way ReadFile does. Overlapped reads and every other file go to ReadFile untouched.
+ *
+ * While `Utils::ReadTrace` records, archive reads are added to the trace, see `readPrefetchFix`. Reads
+ * of the thread replaying the previous trace go straight to ReadFile, they are not the game's.
+ *
  * @param hFile A handle to the device.
  * @param lpBuffer A pointer to the buffer that receives the data read from a file or device.
  * @param nNumberOfBytesToRead The maximum number of bytes to be read.
@@ -346,19 +976,145 @@ BOOL WINAPI kernelBaseDllReadFileHook(
     LPDWORD lpNumberOfBytesRead,
     LPOVERLAPPED lpOverlapped
 ) {
-    char fileName[MAX_PATH] = {0};
-    if (GetFinalPathNameByHandleA(hFile, fileName, MAX_PATH, FILE_NAME_NORMALIZED)) {
-        std::string pathStr(fileName);
-        if (pathStr.starts_with("\\\\?\\")) {
-            pathStr = pathStr.substr(4);
+    if (Utils::ReadTrace::isReplayThread()) {
+        return readFileHook.stdcall<BOOL>(hFile, lpBuffer, nNumberOfBytesToRead, lpNumberOfBytesRead, lpOverlapped);
+    }
+    Utils::AllocScope audit(readFileAllocs);
+    Utils::FileKind kind;
+    {
+        // Only the hook's own work is timed, not the read itself
+        Utils::HookTimer timer(readFileStats);
+        kind = handleCache.find(hFile);
+        if (kind == Utils::FileKind::Unknown) {
+            kind = Utils::classifyFile(hFile);
+            handleCache.insert(hFile, kind);
+        }
+        if (kind == Utils::FileKind::Archive && yml.feature.threads.enable) {
+            threadManager.noteStreamingThread();
         }
-        std::filesystem::path filePath(pathStr);
-        std::string extension = filePath.extension().string();
-        isMoviePlaying = extension == ".wmv" ? true : false;
+        if (movieReads && kind == Utils::FileKind::Movie) {
+            movieState.onMovieRead();
+        }
+        else if (movieReads && kind != Utils::FileKind::Unnamed) {
+            movieState.onOtherRead();
+        }
+        if (kind == Utils::FileKind::Archive && Utils::ReadTrace::recording()) {
+            LARGE_INTEGER position = {};
+            if (lpOverlapped != nullptr) {
+                position.LowPart = lpOverlapped->Offset;
+                position.HighPart = static_cast<LONG>(lpOverlapped->OffsetHigh);
+                Utils::ReadTrace::record(hFile, static_cast<u64>(position.QuadPart), nNumberOfBytesToRead);
+            }
+            else if (SetFilePointerEx(hFile, LARGE_INTEGER{}, &position, FILE_CURRENT)) {
+                Utils::ReadTrace::record(hFile, static_cast<u64>(position.QuadPart), nNumberOfBytesToRead);
+            }
+        }
+    }
+    if (kind == Utils::FileKind::Archive && lpOverlapped == nullptr && lpNumberOfBytesRead != nullptr &&
+        yml.feature.archiveMapping.enable && archiveReader.read(hFile, lpBuffer, nNumberOfBytesToRead, lpNumberOfBytesRead)) {
+        return TRUE;
     }
     return readFileHook.stdcall<BOOL>(hFile, lpBuffer, nNumberOfBytesToRead, lpNumberOfBytesRead, lpOverlapped);
 };
 
+/**
+ * @brief Hook to intercept CloseHandle calls.
+ *
+ * @details
+ * Drops the handle from the ReadFile hook's classification table, Windows reuses handle values so
+ * a closed handle must not keep its classification. Every closed handle is also passed on to the
+ * archive reader and the read trace, which release whatever they kept for it.
+ *
+ * @param hObject A valid handle to an open object.
+ * @return BOOL If the function succeeds, the return value is nonzero (TRUE).
+ *
+ * @note https://learn.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-closehandle
+ */
+BOOL WINAPI kernelBaseDllCloseHandleHook(HANDLE hObject) {
+    {
+        Utils::HookTimer timer(closeHandleStats);
+        Utils::AllocScope audit(closeHandleAllocs);
+        // Not gated on handleCache, it is best effort and a stale archive entry would serve the
+        // next file that gets the same handle value
+        if (yml.feature.archiveMapping.enable) {
+            archiveReader.close(hObject);
+        }
+        if (Utils::ReadTrace::recording()) {
+            Utils::ReadTrace::close(hObject);
+        }
+        handleCache.erase(hObject);
+    }
+    return closeHandleHook.stdcall<BOOL>(hObject);
+}
+
+/**
+ * @brief Hook to intercept IMediaControl::Run calls.
+ *
+ * @details
+ * A graph that runs with a video renderer connected is a movie, playback starts once it runs. Graphs
+ * playing only audio are ignored.
+ *
+ * @param control The filter graph's IMediaControl.
+ * @return HRESULT of the original Run.
+ *
+ * @note https://learn.microsoft.com/en-us/windows/win32/api/control/nf-control-imediacontrol-run
+ */
+HRESULT STDMETHODCALLTYPE mediaControlRunHook(IMediaControl* control) {
+    HRESULT result = graphRunHook.stdcall<HRESULT>(control);
+    if (SUCCEEDED(result) && Utils::graphHasVideo(control)) {
+        movieGraph.store(Utils::comIdentity(control), std::memory_order_relaxed);
+        movieState.setPlaying(true);
+    }
+    return result;
+}
+
+/**
+ * @brief Hook to intercept IMediaControl::Stop calls.
+ *
+ * @details
+ * Stopping the movie's graph ends playback, the game stops it when a movie is skipped or finished.
+ *
+ * @param control The filter graph's IMediaControl.
+ * @return HRESULT of the original Stop.
+ *
+ * @note https://learn.microsoft.com/en-us/windows/win32/api/control/nf-control-imediacontrol-stop
+ */
+HRESULT STDMETHODCALLTYPE mediaControlStopHook(IMediaControl* control) {
+    const void* graph = Utils::comIdentity(control);
+    const void* expected = graph;
+    if (movieGraph.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed)) {
+        movieState.setPlaying(false);
+    }
+    return graphStopHook.stdcall<HRESULT>(control);
+}
+
+/**
+ * @brief Hook to intercept IMediaEvent::GetEvent calls.
+ *
+ * @details
+ * The movie's graph reporting completion or an abort ends playback, before the game gets around
+ * to stopping it.
+ *
+ * @param event The filter graph's IMediaEvent.
+ * @param eventCode Receives the event code.
+ * @param param1 Receives the first event parameter.
+ * @param param2 Receives the second event parameter.
+ * @param timeout Milliseconds to wait for an event.
+ * @return HRESULT of the original GetEvent.
+ *
+ * @note https://learn.microsoft.com/en-us/windows/win32/api/control/nf-control-imediaevent-getevent
+ */
+HRESULT STDMETHODCALLTYPE mediaEventGetEventHook(IMediaEvent* event, long* eventCode, LONG_PTR* param1, LONG_PTR* param2, long timeout) {
+    HRESULT result = graphEventHook.stdcall<HRESULT>(event, eventCode, param1, param2, timeout);
+    if (SUCCEEDED(result) && eventCode != nullptr && Utils::isPlaybackEnd(*eventCode)) {
+        const void* expected = Utils::comIdentity(event);
+        if (movieGraph.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed)) {
+            movieState.setPlaying(false);
+        }
+    }
+    return result;
+}
+
 /**
  * @brief Fixes movies by constraining them to 16:9.
  *
@@ -408,47 +1164,399 @@ BOOL WINAPI kernelBaseDllReadFileHook(
  * But this is the most reliable way to detect if and when a movie is playing. No fancy tricks in the
  * game code, just abusing Windows APIs to our benefit.
  *
+ * That said, the game's calls into quartz.dll can not be hooked, but DirectShow's own methods can.
+ * Every filter graph in the process shares one implementation, so IMediaControl::Run and Stop and
+ * IMediaEvent::GetEvent are found through the vtables of a throwaway graph, see
+ * `Utils::findFilterGraphMethods`, and hooked. A graph with video that runs starts playback, stopping
+ * it or it completing ends playback, exactly when it happens and without looking at any reads. This
+ * is the default, movies.detection set to reads or graph hooks that can not be installed fall back to
+ * the ReadFile hook of `fileHooksFix` as described above.
+ *
  * @return void
  */
-void moviesFix()
-{
-    bool enable = yml.masterEnable;
-    if (enable == true) {
-        std::string targetDll = "KernelBase.dll";
-        HMODULE kernelBaseAddr = GetModuleHandleA(targetDll.c_str());
-        if (!kernelBaseAddr) {
-            LOG("Failed to get handle to {:s}", targetDll.c_str());
-            return;
+void moviesFix() {
+    Utils::FilterGraphMethods methods;
+    if (yml.movies.detection == "graph") {
+        methods = Utils::findFilterGraphMethods();
+    }
+    else if (yml.movies.detection != "reads") {
+        LOG("Unknown movie detection '{}', movies are detected from reads", yml.movies.detection);
+    }
+    if (!methods.run || !methods.stop || !methods.getEvent) {
+        if (yml.movies.detection == "graph") {
+            LOG("Failed to find the filter graph methods, movies are detected from reads");
         }
+        movieReads = true;
+        return;
+    }
 
-        std::string dllFunction = "ReadFile";
-        void* readFileAddr = GetProcAddress(kernelBaseAddr, dllFunction.c_str());
-        if (!readFileAddr) {
-            LOG("Failed to get address of {:s}", dllFunction.c_str());
-            return;
+    // Within a transaction the three hooks go live together on its commit
+    Utils::HookTransaction* transaction = Utils::HookTransaction::current();
+    auto flags = transaction ? SafetyHookInline::StartDisabled : SafetyHookInline::Default;
+    Utils::TraceScope trace("create_inline filter graph");
+    graphRunHook = safetyhook::create_inline(methods.run, reinterpret_cast<void*>(&mediaControlRunHook), flags);
+    graphStopHook = safetyhook::create_inline(methods.stop, reinterpret_cast<void*>(&mediaControlStopHook), flags);
+    graphEventHook = safetyhook::create_inline(methods.getEvent, reinterpret_cast<void*>(&mediaEventGetEventHook), flags);
+    if (!graphRunHook || !graphStopHook || !graphEventHook) {
+        LOG("Failed to hook the filter graph, movies are detected from reads");
+        graphRunHook = {};
+        graphStopHook = {};
+        graphEventHook = {};
+        movieReads = true;
+        return;
+    }
+    if (transaction) {
+        transaction->add("mediaControlRunHook", graphRunHook);
+        transaction->add("mediaControlStopHook", graphStopHook);
+        transaction->add("mediaEventGetEventHook", graphEventHook);
+    }
+    HMODULE quartzAddr = GetModuleHandleA("quartz.dll");
+    if (!quartzAddr) {
+        LOG("Hooked IMediaControl::Run @ {:x}, Stop @ {:x}, IMediaEvent::GetEvent @ {:x}", reinterpret_cast<u64>(methods.run),
+            reinterpret_cast<u64>(methods.stop), reinterpret_cast<u64>(methods.getEvent));
+        return;
+    }
+    LOG("Hooked IMediaControl::Run @ quartz.dll+{:x}", reinterpret_cast<u64>(methods.run) - reinterpret_cast<u64>(quartzAddr));
+    LOG("Hooked IMediaControl::Stop @ quartz.dll+{:x}", reinterpret_cast<u64>(methods.stop) - reinterpret_cast<u64>(quartzAddr));
+    LOG("Hooked IMediaEvent::GetEvent @ quartz.dll+{:x}", reinterpret_cast<u64>(methods.getEvent) - reinterpret_cast<u64>(quartzAddr));
+}
+
+/**
+ * @brief Hooks ReadFile and CloseHandle, for everything that needs to see the game's reads.
+ *
+ * @details
+ * Movies detected from reads, see `moviesFix`, `Utils::ArchiveReader` of archiveMapping, the read
+ * trace of readPrefetch and the streaming threads of `threadsFix` all work off the ReadFile hook.
+ * With none of them enabled the process's busiest I/O path is left unhooked.
+ *
+ * @return void
+ */
+void fileHooksFix() {
+    std::string targetDll = "KernelBase.dll";
+    HMODULE kernelBaseAddr = GetModuleHandleA(targetDll.c_str());
+    if (!kernelBaseAddr) {
+        LOG("Failed to get handle to {:s}", targetDll.c_str());
+        return;
+    }
+
+    // Within a transaction both hooks go live together on its commit
+    Utils::HookTransaction* transaction = Utils::HookTransaction::current();
+    auto flags = transaction ? SafetyHookInline::StartDisabled : SafetyHookInline::Default;
+
+    readFileStats = Utils::HookStats::add("kernelBaseDllReadFileHook");
+    closeHandleStats = Utils::HookStats::add("kernelBaseDllCloseHandleHook");
+    readFileAllocs = Utils::AllocAudit::add("kernelBaseDllReadFileHook");
+    closeHandleAllocs = Utils::AllocAudit::add("kernelBaseDllCloseHandleHook");
+
+    // CloseHandle goes first so nothing gets classified without its close being seen
+    std::string dllFunction = "CloseHandle";
+    void* closeHandleAddr = GetProcAddress(kernelBaseAddr, dllFunction.c_str());
+    if (!closeHandleAddr) {
+        LOG("Failed to get address of {:s}", dllFunction.c_str());
+        return;
+    }
+
+    Utils::TraceScope closeHandleTrace("create_inline CloseHandle");
+    closeHandleHook = safetyhook::create_inline(reinterpret_cast<void*>(closeHandleAddr), reinterpret_cast<void*>(&kernelBaseDllCloseHandleHook), flags);
+    if (transaction) {
+        transaction->add("kernelBaseDllCloseHandleHook", closeHandleHook);
+    }
+    LOG("Hooked {:s} @ {:s}+{:x}", dllFunction.c_str(), targetDll.c_str(), reinterpret_cast<u64>(closeHandleAddr) - reinterpret_cast<u64>(kernelBaseAddr));
+
+    dllFunction = "ReadFile";
+    void* readFileAddr = GetProcAddress(kernelBaseAddr, dllFunction.c_str());
+    if (!readFileAddr) {
+        LOG("Failed to get address of {:s}", dllFunction.c_str());
+        return;
+    }
+
+    Utils::TraceScope readFileTrace("create_inline ReadFile");
+    readFileHook = safetyhook::create_inline(reinterpret_cast<void*>(readFileAddr), reinterpret_cast<void*>(&kernelBaseDllReadFileHook), flags);
+    if (transaction) {
+        transaction->add("kernelBaseDllReadFileHook", readFileHook);
+    }
+    LOG("Hooked {:s} @ {:s}+{:x}", dllFunction.c_str(), targetDll.c_str(), reinterpret_cast<u64>(readFileAddr) - reinterpret_cast<u64>(kernelBaseAddr));
+}
+
+/**
+ * @brief Hook to intercept IDXGISwapChain::Present calls.
+ *
+ * @details
+ * Holds every frame to the deadline of `framePacer` before it is presented, and with unlock enabled
+ * presents without waiting for vsync. Both are read from the current snapshot each frame so hot
+ * reloading the framerate section takes effect on the next frame. Test presents are not frames and
+ * are passed through.
+ *
+ * While a telemetry capture runs the frame is also timed around the pacer and the original Present,
+ * see `telemetryFix`.
+ *
+ * @param swapChain The swap chain presenting.
+ * @param syncInterval How to synchronize with vertical blanks, 0 presents immediately.
+ * @param flags DXGI_PRESENT flags.
+ * @return HRESULT of the original Present.
+ *
+ * @note https://learn.microsoft.com/en-us/windows/win32/api/dxgi/nf-dxgi-idxgiswapchain-present
+ */
+HRESULT WINAPI dxgiPresentHook(IDXGISwapChain* swapChain, UINT syncInterval, UINT flags) {
+    if ((flags & DXGI_PRESENT_TEST) != 0) {
+        return presentHook.stdcall<HRESULT>(swapChain, syncInterval, flags);
+    }
+    Utils::AllocScope audit(presentAllocs);
+    if (yml.feature.threads.enable) {
+        threadManager.noteRenderThread();
+    }
+    telemetry.beginFrame();
+    const fixConstants_t* constants = fix.current();
+    if (constants->unlockFramerate) {
+        syncInterval = 0;
+    }
+    framePacer.wait(constants->targetFps);
+    telemetry.pacedFrame();
+    HRESULT result = presentHook.stdcall<HRESULT>(swapChain, syncInterval, flags);
+    if (telemetry.capturing()) {
+        telemetry.endFrame(movieState.movie(), hudHits.exchange(0, std::memory_order_relaxed));
+    }
+    return result;
+}
+
+/**
+ * @brief Replaces the game's frame cap with an even frame pacer.
+ *
+ * @details
+ * The game caps its frame rate by presenting with vsync, which ties it to the display's refresh rate,
+ * and frame times are only as even as the engine's own coarse sleeps. Present is hooked instead, the
+ * pacer waits for each frame's deadline on a high resolution timer and spins the last fraction of a
+ * millisecond, see `Utils::FramePacer`. Unlock presents without vsync so the target is not capped by
+ * the refresh rate.
+ *
+ * Present is found through the vtable of a throwaway swap chain, there is no game code to scan for.
+ * With hotReload, telemetry or threads enabled the hook is installed even with no target set.
+ *
+ * @return void
+ */
+void framerateFix() {
+    void* presentAddr = Utils::findSwapChainPresent();
+    if (!presentAddr) {
+        LOG("Failed to get address of IDXGISwapChain::Present");
+        return;
+    }
+    Utils::HookTransaction* transaction = Utils::HookTransaction::current();
+    auto flags = transaction ? SafetyHookInline::StartDisabled : SafetyHookInline::Default;
+    presentAllocs = Utils::AllocAudit::add("dxgiPresentHook");
+    Utils::TraceScope trace("create_inline Present");
+    presentHook = safetyhook::create_inline(presentAddr, reinterpret_cast<void*>(&dxgiPresentHook), flags);
+    if (transaction) {
+        transaction->add("dxgiPresentHook", presentHook);
+    }
+    HMODULE dxgiAddr = GetModuleHandleA("dxgi.dll");
+    LOG("Hooked IDXGISwapChain::Present @ dxgi.dll+{:x}", reinterpret_cast<u64>(presentAddr) - reinterpret_cast<u64>(dxgiAddr));
+}
+
+/**
+ * @brief Captures per-frame timings on a hotkey, to measure the hooks against the frame budget.
+ *
+ * @details
+ * The hotkey, F10 unless set otherwise, starts a capture and pressing it again writes it to
+ * GodEater1-2Fix.frames.csv: per frame the frame time, the CPU time between presents, the time spent
+ * in the frame pacer and in Present, the number of the movie playing, 0 if none, and how often the HUD
+ * hook ran. See `Utils::FrameTelemetry`, frames are timed by the Present hook of `framerateFix`.
+ *
+ * @return void
+ */
+void telemetryFix() {
+    telemetry.startHotkey(yml.feature.telemetry.hotkey, modFile("GodEater1-2Fix.frames.csv").string());
+}
+
+/**
+ * @brief Schedules the game's threads by role, as set in the config.
+ *
+ * @details
+ * The game leaves all of its threads at normal priority with no preference for any core, so on
+ * hybrid CPUs its render thread may land on an efficiency core while archive streaming and DirectShow
+ * compete with it. Each role gets its own priority, cores and power throttling, see
+ * `Utils::ThreadManager`. The render thread is reported by the Present hook of `framerateFix` and the
+ * streaming threads by the ReadFile hook, movie and worker threads are told apart by where they start.
+ *
+ * @return void
+ */
+void threadsFix() {
+    const threads_t& threads = yml.feature.threads;
+    threadManager.setRule(Utils::ThreadManager::Role::Render,
+        Utils::ThreadManager::parseRule(threads.render.priority, threads.render.cores, threads.render.qos));
+    threadManager.setRule(Utils::ThreadManager::Role::Streaming,
+        Utils::ThreadManager::parseRule(threads.streaming.priority, threads.streaming.cores, threads.streaming.qos));
+    threadManager.setRule(Utils::ThreadManager::Role::Movie,
+        Utils::ThreadManager::parseRule(threads.movie.priority, threads.movie.cores, threads.movie.qos));
+    threadManager.setRule(Utils::ThreadManager::Role::Worker,
+        Utils::ThreadManager::parseRule(threads.worker.priority, threads.worker.cores, threads.worker.qos));
+    threadManager.start(5000);
+}
+
+/**
+ * @brief Warms the page cache with the archive reads of the previous session.
+ *
+ * @details
+ * Loading the main menu and hub reads hundreds of megabytes out of the .qpck archives in small chunks,
+ * from a cold disk that is most of the load time. The first recordSeconds of each session are recorded
+ * by the ReadFile hook of `fileHooksFix` and at the next launch a background thread reads the same ranges
+ * in the same order ahead of the game, see `Utils::ReadTrace`. Traces are kept per exe, GER.exe and
+ * GE2RB.exe each have their own.
+ *
+ * @return void
+ */
+void readPrefetchFix() {
+    std::string exe = module.name.substr(0, module.name.find_last_of('.'));
+    Utils::ReadTrace::start(modFile("GodEater1-2Fix." + exe + ".readtrace").string(), module.timeDateStamp, yml.feature.readPrefetch.recordSeconds);
+}
+
+/**
+ * @brief Every fix, in the order they are applied, with what they hook and when they apply.
+ *
+ * @details
+ * Each entry names the signature the fix hooks, nullptr if it does not hook game code, the stage it
+ * runs in and the enable predicate over `yml`. The startup works on the whole table: `scanSignatures`
+ * resolves the signatures of every enabled fix in one batch, `runFixes` logs and applies them stage by
+ * stage and the hooks stage is installed as one `Utils::HookTransaction`. A fix's apply function only runs when its predicate holds and does not
+ * check it again.
+ *
+ * - **Early:** Before the signature scan, prepares what `DllMain` applies on the next launch.
+ * - **Hooks:** Installs hooks, all of them are committed together as one `Utils::HookTransaction`.
+ * - **Late:** Needs the hooks to be live, e.g. background threads fed by them.
+ */
+const std::array<fix_t, 11> fixes = {{
+    { "nativeResolutionFix", fixStage_t::Early, &nativeResolutionSignature, nativeResolutionFix,
+        []() { return yml.masterEnable && yml.feature.earlyInject.enable; } },
+    { "moviesFix", fixStage_t::Hooks, nullptr, moviesFix,
+        []() { return yml.masterEnable; } },
+    { "fileHooksFix", fixStage_t::Hooks, nullptr, fileHooksFix,
+        []() { return yml.masterEnable && (movieReads || yml.feature.archiveMapping.enable || yml.feature.readPrefetch.enable ||
+            yml.feature.threads.enable); } },
+    { "aspectRatioFix", fixStage_t::Hooks, &aspectRatioSignature, aspectRatioFix,
+        []() { return yml.masterEnable && nativeResolutionPatched == false; } },
+    { "resolutionFix", fixStage_t::Hooks, &resolutionSignature, resolutionFix,
+        []() { return yml.masterEnable; } },
+    { "hudElementsFix", fixStage_t::Hooks, &hudElementsSignature, hudElementsFix,
+        []() { return yml.masterEnable && (yml.feature.constrainHud.enable || yml.feature.hotReload.enable || yml.feature.telemetry.enable); } },
+    { "framerateFix", fixStage_t::Hooks, nullptr, framerateFix,
+        []() { return yml.masterEnable && (yml.framerate.target != 0 || yml.framerate.unlock || yml.feature.hotReload.enable || yml.feature.telemetry.enable ||
+            yml.feature.threads.enable); } },
+    { "readPrefetchFix", fixStage_t::Late, nullptr, readPrefetchFix,
+        []() { return yml.masterEnable && yml.feature.readPrefetch.enable && hooksCommitted && static_cast<bool>(readFileHook); } },
+    { "telemetryFix", fixStage_t::Late, nullptr, telemetryFix,
+        []() { return yml.masterEnable && yml.feature.telemetry.enable && hooksCommitted && static_cast<bool>(presentHook); } },
+    { "threadsFix", fixStage_t::Late, nullptr, threadsFix,
+        []() { return yml.masterEnable && yml.feature.threads.enable; } },
+    { "hotReloadFix", fixStage_t::Late, nullptr, hotReloadFix,
+        []() { return yml.masterEnable && yml.feature.hotReload.enable; } },
+}};
+
+/**
+ * @brief Whether a fix is enabled.
+ *
+ * @param entry Fix to check.
+ * @return bool True if the fix should be applied.
+ */
+bool fixEnabled(const fix_t& entry) {
+    return entry.enabled();
+}
+
+/**
+ * @brief Applies every enabled fix of a stage, in table order.
+ *
+ * @param stage Stage to run.
+ * @return void
+ */
+void runFixes(fixStage_t stage) {
+    for (const fix_t& entry : fixes) {
+        if (entry.stage != stage) {
+            continue;
+        }
+        bool enable = fixEnabled(entry);
+        LOG("Fix {} {}", entry.name, enable ? "Enabled" : "Disabled");
+        if (enable) {
+            runPhase(entry.name, entry.apply);
         }
+    }
+}
+
+/**
+ * @brief Resolves the signatures of all fixes in a single pass over the game's memory.
+ *
+ * @details
+ * Each fix would otherwise scan the whole image on its own in `Utils::injectCave`. Only signatures
+ * of enabled fixes of the hooks stage in `fixes` are scanned for.
+ * Builds listed in cmake/KnownBuilds.csv, none are so far, use the RVAs listed there. Signatures resolved
+ * on a previous run of the same exe build are taken from GodEater1-2Fix.cache, which lives next to
+ * the mod, and only the remaining ones are scanned for.
+ *
+ * @return void
+ */
+void scanSignatures() {
+    if (yml.masterEnable == false) {
+        return;
+    }
 
-        readFileHook = safetyhook::create_inline(reinterpret_cast<void*>(readFileAddr), reinterpret_cast<void*>(&kernelBaseDllReadFileHook));
-        LOG("Hooked {:s} @ {:s}+{:x}", dllFunction.c_str(), targetDll.c_str(), reinterpret_cast<u64>(readFileAddr) - reinterpret_cast<u64>(kernelBaseAddr));
+    std::vector<Utils::SignatureHook*> hooks;
+    for (const fix_t& entry : fixes) {
+        if (entry.stage == fixStage_t::Hooks && entry.signature != nullptr && fixEnabled(entry)) {
+            hooks.push_back(entry.signature);
+        }
+    }
+    if (Utils::isKnownBuild(module)) {
+        LOG("Known build {:s} {:08X}/{:08X}", module.name, module.timeDateStamp, module.checkSum);
+    }
+    else {
+        LOG("Build {:s} {:08X}/{:08X} is not in the known builds table, signatures will be scanned for", module.name, module.timeDateStamp, module.checkSum);
     }
+    Utils::loadSignatureCache(module, modFile("GodEater1-2Fix.cache").string());
+    Utils::resolveSignatures(module, hooks, yml.scanner.threads);
+    LOG("Resolved {} signatures", hooks.size());
 }
 
 /**
  * @brief This function serves as the entry point for the DLL. It performs the following tasks:
  * 1. Initializes the logging system.
  * 2. Reads the configuration from a YAML file.
- * 3. Applies a center UI fix.
+ * 3. Applies the fixes in `fixes`, their hooks as one `Utils::HookTransaction`. If that fails every hook
+ *    is rolled back and the late fixes, which need the hooks, are skipped.
  *
  * @param lpParameter Unused parameter.
  * @return Always returns TRUE to indicate successful execution.
  */
 DWORD WINAPI Main(void* lpParameter) {
-    logInit();
-    readYml();
-    moviesFix();
-    aspectRatioFix();
-    resolutionFix();
-    hudElementsFix();
+    runPhase("init", init);
+    runFixes(fixStage_t::Early);
+    if (!yml.masterEnable || !yml.feature.earlyInject.enable) {
+        // A record left by an earlier run would keep patching from DllMain
+        std::error_code error;
+        std::filesystem::remove(modFile(earlyName), error);
+    }
+    runPhase("scanSignatures", scanSignatures);
+    {
+        Utils::HookTransaction hooks("startup");
+        runFixes(fixStage_t::Hooks);
+        hooksCommitted = hooks.commit();
+    }
+    // The game is running by now, the rest of the mod's startup yields to it
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+    if (hooksCommitted) {
+        runFixes(fixStage_t::Late);
+        LOG("Hooks live after {:.1f} ms since process start", Utils::Trace::msSinceProcessStart());
+    }
+    else {
+        LOG("Startup hooks failed to commit and were rolled back, skipping the late fixes");
+    }
+    if (yml.logging.startupTrace) {
+        std::string tracePath = modFile("GodEater1-2Fix.trace.json").string();
+        if (Utils::Trace::write(tracePath)) {
+            LOG("Startup trace written to {}", tracePath);
+        }
+        else {
+            LOG("Failed to write startup trace {}", tracePath);
+        }
+    }
+    Utils::HookStats::start(10000);
+    Utils::AllocAudit::start(10000);
     return true;
 }
 
@@ -465,7 +1573,10 @@ DWORD WINAPI Main(void* lpParameter) {
  *
  * - **DLL_PROCESS_ATTACH**: When the DLL is loaded into the address space of a process, it
  *   creates a new thread to run the `Main` function. The thread priority is set to the highest,
- *   and the thread handle is closed after creation.
+ *   and the thread handle is closed after creation. Before that the mod's folder is taken from
+ *   `hModule`, see `modFile`, and `earlyPatch` patches the native resolution before the game gets
+ *   to read it, if an earlier run left a record for it. The config is not read while the loader
+ *   lock is held.
  *
  * - **DLL_THREAD_ATTACH**: Called when a new thread is created in the process. No action is taken
  *   in this implementation.
@@ -488,6 +1599,14 @@ BOOL APIENTRY DllMain(
     HANDLE mainHandle;
     switch (ul_reason_for_call) {
     case DLL_PROCESS_ATTACH:
+        {
+            WCHAR modPath[MAX_PATH] = { 0 };
+            DWORD length = GetModuleFileNameW(hModule, modPath, MAX_PATH);
+            if (length != 0 && length < MAX_PATH) {
+                modFolder = std::filesystem::path(modPath).parent_path();
+            }
+        }
+        earlyPatch();
         mainHandle = CreateThread(NULL, 0, Main, 0, NULL, 0);
         if (mainHandle)
         {
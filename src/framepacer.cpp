@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi.h>
+
+#include "framepacer.hpp"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace
+{
+    i64 now()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+}
+
+namespace Utils
+{
+    FramePacer::~FramePacer()
+    {
+        if (timer != nullptr) {
+            CloseHandle(timer);
+        }
+    }
+
+    void FramePacer::wait(u32 targetFps)
+    {
+        if (targetFps == 0) {
+            fps = 0;
+            next = 0;
+            return;
+        }
+        if (frequency == 0) {
+            LARGE_INTEGER counter;
+            QueryPerformanceFrequency(&counter);
+            frequency = counter.QuadPart;
+        }
+        if (targetFps != fps) {
+            fps = targetFps;
+            period = frequency / fps;
+            next = 0;
+        }
+
+        i64 current = now();
+        if (next == 0 || current - next > period) {
+            next = current;
+        }
+        else {
+            sleepUntil(next);
+        }
+        next += period;
+    }
+
+    void FramePacer::sleepUntil(i64 deadline)
+    {
+        if (!timerCreated) {
+            timerCreated = true;
+            timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            f64 spin = spinHighResolution;
+            if (timer == nullptr) {
+                timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+                spin = spinLegacy;
+            }
+            spinTicks = static_cast<i64>(spin * static_cast<f64>(frequency));
+        }
+
+        i64 remaining = deadline - now();
+        if (timer != nullptr && remaining > spinTicks) {
+            // Relative due times are negative, in 100 ns units
+            LARGE_INTEGER due;
+            due.QuadPart = -((remaining - spinTicks) * 10000000 / frequency);
+            if (SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(timer, INFINITE);
+            }
+        }
+        while (now() < deadline) {
+            YieldProcessor();
+        }
+    }
+
+    void* findSwapChainPresent()
+    {
+        HWND window = CreateWindowExW(0, L"STATIC", L"GodEater1-2Fix", WS_OVERLAPPEDWINDOW, 0, 0, 8, 8, nullptr, nullptr, nullptr, nullptr);
+        if (window == nullptr) {
+            return nullptr;
+        }
+
+        DXGI_SWAP_CHAIN_DESC desc = {};
+        desc.BufferCount = 1;
+        desc.BufferDesc.Width = 8;
+        desc.BufferDesc.Height = 8;
+        desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        desc.OutputWindow = window;
+        desc.SampleDesc.Count = 1;
+        desc.Windowed = TRUE;
+        desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+
+        void* present = nullptr;
+        for (D3D_DRIVER_TYPE driver : { D3D_DRIVER_TYPE_HARDWARE, D3D_DRIVER_TYPE_WARP }) {
+            IDXGISwapChain* swapChain = nullptr;
+            ID3D11Device* device = nullptr;
+            ID3D11DeviceContext* context = nullptr;
+            HRESULT result = D3D11CreateDeviceAndSwapChain(nullptr, driver, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+                &desc, &swapChain, &device, nullptr, &context);
+            if (SUCCEEDED(result)) {
+                // Present is the 9th entry, after IUnknown's 3, IDXGIObject's 4 and IDXGIDeviceSubObject's 1
+                present = (*reinterpret_cast<void***>(swapChain))[8];
+                swapChain->Release();
+                context->Release();
+                device->Release();
+                break;
+            }
+        }
+        DestroyWindow(window);
+        return present;
+    }
+}
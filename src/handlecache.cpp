@@ -0,0 +1,67 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <cwctype>
+#include <string_view>
+
+#include "handlecache.hpp"
+
+namespace
+{
+    bool extensionIs(std::wstring_view path, std::wstring_view extension)
+    {
+        if (path.size() < extension.size()) {
+            return false;
+        }
+        auto tail = path.substr(path.size() - extension.size());
+        for (size_t i = 0; i < extension.size(); ++i) {
+            if (static_cast<wchar_t>(std::towlower(tail[i])) != extension[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace Utils
+{
+    FileKind classifyFile(HANDLE file)
+    {
+        WCHAR path[MAX_PATH];
+        DWORD length = GetFinalPathNameByHandleW(file, path, MAX_PATH, FILE_NAME_NORMALIZED);
+        if (length == 0 || length >= MAX_PATH) {
+            return FileKind::Unnamed;
+        }
+
+        std::wstring_view view(path, length);
+        if (extensionIs(view, L".wmv")) {
+            return FileKind::Movie;
+        }
+        if (extensionIs(view, L".qpck")) {
+            return FileKind::Archive;
+        }
+        return FileKind::Other;
+    }
+}
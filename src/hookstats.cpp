@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifdef HOOK_STATS
+
+#include <windows.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+#include "hookstats.hpp"
+
+namespace
+{
+    using Utils::HookStats;
+
+    /**
+     * Counters of one hook on one thread, only ever written by that thread.
+     */
+    struct Counters {
+        std::atomic<u64> hits;
+        std::atomic<u64> cycles;
+        std::array<std::atomic<u64>, HookStats::buckets> histogram;
+    };
+
+    /**
+     * Counters of every hook on one thread. Blocks of threads that exited are kept, their
+     * counts are still part of the totals.
+     */
+    struct ThreadBlock {
+        std::array<Counters, HookStats::maxHooks> hooks;
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::string> names;
+    std::vector<ThreadBlock*> blocks;
+    std::array<std::atomic<u32>, HookStats::maxHooks> caveHits;
+    thread_local ThreadBlock* localBlock = nullptr;
+    u32 reportIntervalMs = 0;
+
+    ThreadBlock* registerThread()
+    {
+        auto block = new ThreadBlock();
+        std::lock_guard lock(registryMutex);
+        blocks.push_back(block);
+        return block;
+    }
+
+    /**
+     * Totals of one hook, summed over all threads.
+     */
+    struct Totals {
+        u64 hits = 0;
+        u64 cycles = 0;
+        u64 caveHits = 0;
+        std::array<u64, HookStats::buckets> histogram = {};
+    };
+
+    /**
+     * Upper bound in cycles of the bucket holding the given fraction of timed hits.
+     */
+    u64 percentile(const Totals& totals, f64 fraction)
+    {
+        u64 target = static_cast<u64>(static_cast<f64>(totals.hits) * fraction);
+        u64 seen = 0;
+        for (size_t bucket = 0; bucket < HookStats::buckets; ++bucket) {
+            seen += totals.histogram[bucket];
+            if (seen > target) {
+                return u64(1) << bucket;
+            }
+        }
+        return u64(1) << (HookStats::buckets - 1);
+    }
+
+    DWORD WINAPI reportThread(void* lpParameter)
+    {
+        std::vector<Totals> previous;
+        while (true) {
+            Sleep(reportIntervalMs);
+
+            std::vector<Totals> current;
+            std::vector<std::string> reported;
+            {
+                std::lock_guard lock(registryMutex);
+                reported = names;
+                current.resize(names.size());
+                for (ThreadBlock* block : blocks) {
+                    for (size_t id = 0; id < current.size(); ++id) {
+                        const Counters& counters = block->hooks[id];
+                        current[id].hits += counters.hits.load(std::memory_order_relaxed);
+                        current[id].cycles += counters.cycles.load(std::memory_order_relaxed);
+                        for (size_t bucket = 0; bucket < HookStats::buckets; ++bucket) {
+                            current[id].histogram[bucket] += counters.histogram[bucket].load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+                for (size_t id = 0; id < current.size(); ++id) {
+                    current[id].caveHits = caveHits[id].load(std::memory_order_relaxed);
+                }
+            }
+            previous.resize(current.size());
+
+            for (size_t id = 0; id < current.size(); ++id) {
+                Totals delta;
+                delta.hits = current[id].hits - previous[id].hits;
+                delta.cycles = current[id].cycles - previous[id].cycles;
+                // Cave counters are 32 bit and may wrap between reports
+                delta.caveHits = static_cast<u32>(current[id].caveHits - previous[id].caveHits);
+                for (size_t bucket = 0; bucket < HookStats::buckets; ++bucket) {
+                    delta.histogram[bucket] = current[id].histogram[bucket] - previous[id].histogram[bucket];
+                }
+                if (delta.hits != 0) {
+                    LOG("{}: {} hits, avg {} cycles, p50 < {} cycles, p99 < {} cycles", reported[id], delta.hits,
+                        delta.cycles / delta.hits, percentile(delta, 0.50), percentile(delta, 0.99));
+                }
+                if (delta.caveHits != 0) {
+                    LOG("{}: {} cave hits", reported[id], delta.caveHits);
+                }
+            }
+            previous = std::move(current);
+        }
+        return 0;
+    }
+}
+
+namespace Utils
+{
+    u32 HookStats::add(const std::string& name)
+    {
+        std::lock_guard lock(registryMutex);
+        // The last id is kept for "other" from the start, no hook's counters get relabelled
+        if (names.size() >= maxHooks - 1) {
+            if (names.size() == maxHooks - 1) {
+                names.push_back("other");
+            }
+            return maxHooks - 1;
+        }
+        names.push_back(name);
+        return static_cast<u32>(names.size() - 1);
+    }
+
+    void HookStats::record(u32 id, u64 cycles)
+    {
+        if (localBlock == nullptr) {
+            localBlock = registerThread();
+        }
+        // Only this thread writes its block, plain relaxed stores are enough
+        Counters& counters = localBlock->hooks[id];
+        size_t bucket = std::min<size_t>(std::bit_width(cycles), buckets - 1);
+        counters.hits.store(counters.hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counters.cycles.store(counters.cycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+        counters.histogram[bucket].store(counters.histogram[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<u32>* HookStats::caveCounter(u32 id)
+    {
+        return &caveHits[id];
+    }
+
+    void HookStats::start(u32 intervalMs)
+    {
+        reportIntervalMs = std::max<u32>(intervalMs, 100);
+        HANDLE reportHandle = CreateThread(nullptr, 0, reportThread, nullptr, 0, nullptr);
+        if (reportHandle) {
+            SetThreadPriority(reportHandle, THREAD_PRIORITY_LOWEST);
+            CloseHandle(reportHandle);
+        }
+        LOG("Reporting hook stats every {} ms", reportIntervalMs);
+    }
+}
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <cstring>
+
+#include <safetyhook/os.hpp>
+
+#include "hooktransaction.hpp"
+#include "utils.hpp"
+
+namespace
+{
+    /**
+     * Innermost transaction open on this thread, transactions nest.
+     */
+    thread_local Utils::HookTransaction* openTransaction = nullptr;
+}
+
+namespace Utils
+{
+    HookTransaction::HookTransaction(std::string name) : name(std::move(name)), previous(openTransaction)
+    {
+        openTransaction = this;
+    }
+
+    HookTransaction::~HookTransaction()
+    {
+        openTransaction = previous;
+        if (!committed && (!patches.empty() || !hooks.empty())) {
+            LOG("Hook transaction {} discarded, {} hooks left uninstalled", name, patches.size() + hooks.size());
+        }
+    }
+
+    HookTransaction* HookTransaction::current()
+    {
+        return openTransaction;
+    }
+
+    void HookTransaction::addPatch(std::string name, std::uintptr_t site, std::vector<std::uint8_t> bytes,
+        std::vector<std::pair<std::uintptr_t, std::uintptr_t>> moves)
+    {
+        std::vector<u8> original(bytes.size());
+        std::memcpy(original.data(), reinterpret_cast<const void*>(site), original.size());
+        patches.push_back({ std::move(name), site, std::move(bytes), std::move(original), std::move(moves) });
+    }
+
+    void HookTransaction::add(std::string name, SafetyHookInline& hook)
+    {
+        hooks.push_back({
+            std::move(name),
+            [&hook]() { return static_cast<bool>(hook) && hook.enable().has_value(); },
+            [&hook]() { (void)hook.disable(); }
+        });
+    }
+
+    bool HookTransaction::commit()
+    {
+        Utils::TraceScope trace("HookTransaction::commit " + name);
+        committed = true;
+        size_t count = patches.size() + hooks.size();
+        if (count == 0) {
+            return true;
+        }
+
+        // Overlapping patches would write over each other and restore the wrong bytes on a rollback
+        for (size_t i = 0; i < patches.size(); ++i) {
+            for (size_t j = i + 1; j < patches.size(); ++j) {
+                const Patch& a = patches[i];
+                const Patch& b = patches[j];
+                if (a.site < b.site + b.bytes.size() && b.site < a.site + a.bytes.size()) {
+                    LOG("Hook transaction {} failed, {} overlaps {}, none of its {} hooks are installed", name, a.name, b.name, count);
+                    return false;
+                }
+            }
+        }
+
+        // Only the raw writes run frozen, a suspended thread may hold the heap lock and safetyhook's
+        // `enable` allocates, it freezes the threads on its own
+        auto writeFrozen = [this](bool restore) {
+            safetyhook::execute_while_frozen(
+                [this, restore]() {
+                    for (const Patch& patch : patches) {
+                        const std::vector<u8>& bytes = restore ? patch.original : patch.bytes;
+                        Utils::patch(patch.site, bytes);
+                        FlushInstructionCache(GetCurrentProcess(), reinterpret_cast<void*>(patch.site), bytes.size());
+                    }
+                },
+                [this](safetyhook::ThreadId, safetyhook::ThreadHandle, safetyhook::ThreadContext context) {
+                    // Valid even after a rollback, the destinations run the displaced instructions and jump back
+                    for (const Patch& patch : patches) {
+                        for (auto [from, to] : patch.moves) {
+                            safetyhook::fix_ip(context, reinterpret_cast<u8*>(from), reinterpret_cast<u8*>(to));
+                        }
+                    }
+                }
+            );
+        };
+
+        if (!patches.empty()) {
+            writeFrozen(false);
+        }
+        size_t enabled = 0;
+        for (; enabled < hooks.size(); ++enabled) {
+            if (!hooks[enabled].enable()) {
+                break;
+            }
+        }
+        if (enabled < hooks.size()) {
+            const std::string& failed = hooks[enabled].name;
+            while (enabled > 0) {
+                hooks[--enabled].disable();
+            }
+            if (!patches.empty()) {
+                writeFrozen(true);
+            }
+            LOG("Hook transaction {} failed to enable {}, rolled back, none of its {} hooks are installed", name, failed, count);
+            return false;
+        }
+        LOG("Hook transaction {}: {} patches installed under one freeze, {} hooks enabled", name, patches.size(), hooks.size());
+        return true;
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <dshow.h>
+
+#include "moviegraph.hpp"
+
+namespace Utils
+{
+    FilterGraphMethods findFilterGraphMethods()
+    {
+        FilterGraphMethods methods;
+        // The mod's own thread, any apartment will do, it is left the way it was found
+        HRESULT initialized = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        IMediaControl* control = nullptr;
+        if (SUCCEEDED(CoCreateInstance(CLSID_FilterGraph, nullptr, CLSCTX_INPROC_SERVER, IID_IMediaControl, reinterpret_cast<void**>(&control)))) {
+            // Run and Stop are the 8th and 10th entries, after IUnknown's 3 and IDispatch's 4
+            void** controlTable = *reinterpret_cast<void***>(control);
+            methods.run = controlTable[7];
+            methods.stop = controlTable[9];
+
+            IMediaEvent* event = nullptr;
+            if (SUCCEEDED(control->QueryInterface(IID_IMediaEvent, reinterpret_cast<void**>(&event)))) {
+                // GetEvent is the 9th entry, after IUnknown's 3, IDispatch's 4 and GetEventHandle
+                methods.getEvent = (*reinterpret_cast<void***>(event))[8];
+                event->Release();
+            }
+            // quartz.dll could be unloaded once the graph is gone and COM uninitialized, pinned it
+            // stays for the hooks to live in
+            HMODULE quartz = nullptr;
+            if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_PIN | GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+                static_cast<LPCWSTR>(methods.run), &quartz)) {
+                methods = {};
+            }
+            control->Release();
+        }
+
+        if (SUCCEEDED(initialized)) {
+            CoUninitialize();
+        }
+        return methods;
+    }
+
+    bool graphHasVideo(IUnknown* graph)
+    {
+        // The graph always exposes IBasicVideo, it only answers with a video renderer behind it
+        IBasicVideo* video = nullptr;
+        if (FAILED(graph->QueryInterface(IID_IBasicVideo, reinterpret_cast<void**>(&video)))) {
+            return false;
+        }
+        long width = 0;
+        bool hasVideo = SUCCEEDED(video->get_SourceWidth(&width));
+        video->Release();
+        return hasVideo;
+    }
+
+    const void* comIdentity(IUnknown* object)
+    {
+        IUnknown* identity = nullptr;
+        if (FAILED(object->QueryInterface(IID_IUnknown, reinterpret_cast<void**>(&identity)))) {
+            return object;
+        }
+        identity->Release();
+        return identity;
+    }
+
+    bool isPlaybackEnd(long eventCode)
+    {
+        return eventCode == EC_COMPLETE || eventCode == EC_USERABORT || eventCode == EC_ERRORABORT;
+    }
+}
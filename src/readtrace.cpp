@@ -0,0 +1,333 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils.hpp"
+#include "readtrace.hpp"
+
+namespace
+{
+    using Utils::ReadTrace;
+
+    struct Header {
+        u32 magic;
+        u32 version;
+        u32 timeDateStamp;
+        u32 archiveCount;
+        u32 recordCount;
+    };
+
+    struct Record {
+        u32 archive;
+        u32 length;
+        u64 offset;
+    };
+    static_assert(sizeof(Record) == 16, "Records are written as is");
+
+    // "GERT" read as a little endian u32
+    constexpr u32 traceMagic = 0x54524547;
+    constexpr u32 traceVersion = 1;
+    constexpr u32 noArchive = 0xFFFFFFFF;
+
+    std::atomic<bool> active = false;
+    std::mutex recordMutex;
+    // Fixed tables and reserved records, recording runs inside the ReadFile hook and never allocates
+    struct Handle {
+        HANDLE file;
+        u32 archive;
+    };
+    std::array<Handle, ReadTrace::maxArchives> handles{};
+    std::vector<Utils::FixedPath> archives;
+    std::vector<Record> records;
+    u64 recordedBytes = 0;
+    thread_local bool replayThread = false;
+
+    std::string tracePath;
+    u32 traceTimeDateStamp = 0;
+    u32 recordMs = 0;
+    ULONGLONG startTick = 0;
+
+    /**
+     * Directory of the game's exe, with a trailing backslash.
+     */
+    std::wstring gameFolder()
+    {
+        WCHAR path[MAX_PATH];
+        DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+        std::wstring_view view(path, length == MAX_PATH ? 0 : length);
+        size_t slash = view.find_last_of(L"\\/");
+        return slash == std::wstring_view::npos ? std::wstring() : std::wstring(view.substr(0, slash + 1));
+    }
+
+    /**
+     * File name of the archive behind a handle, empty if it can not be retrieved.
+     */
+    Utils::FixedPath archiveName(HANDLE file)
+    {
+        Utils::FixedPath name;
+        WCHAR path[MAX_PATH];
+        DWORD length = GetFinalPathNameByHandleW(file, path, MAX_PATH, FILE_NAME_NORMALIZED);
+        if (length == 0 || length >= MAX_PATH) {
+            return name;
+        }
+        std::wstring_view view(path, length);
+        size_t slash = view.find_last_of(L"\\/");
+        name.assign(slash == std::wstring_view::npos ? view : view.substr(slash + 1));
+        return name;
+    }
+
+    bool load(std::vector<std::wstring>& names, std::vector<Record>& trace, std::string& error)
+    {
+        std::ifstream file(tracePath, std::ios::binary);
+        if (!file) {
+            error = "no trace recorded yet";
+            return false;
+        }
+        Header header = {};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || header.magic != traceMagic || header.version != traceVersion) {
+            error = "not a trace of this version";
+            return false;
+        }
+        if (header.timeDateStamp != traceTimeDateStamp) {
+            error = std::format("recorded by another build {:08X}", header.timeDateStamp);
+            return false;
+        }
+        if (header.recordCount > ReadTrace::maxRecords) {
+            error = "too many records";
+            return false;
+        }
+        for (u32 i = 0; i < header.archiveCount && file; ++i) {
+            u16 length = 0;
+            file.read(reinterpret_cast<char*>(&length), sizeof(length));
+            std::wstring name(length, L'\0');
+            file.read(reinterpret_cast<char*>(name.data()), length * sizeof(wchar_t));
+            names.push_back(std::move(name));
+        }
+        trace.resize(header.recordCount);
+        file.read(reinterpret_cast<char*>(trace.data()), trace.size() * sizeof(Record));
+        if (!file) {
+            error = "truncated";
+            return false;
+        }
+        for (const Record& record : trace) {
+            if (record.archive >= names.size()) {
+                error = "record of an unknown archive";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool save(const std::vector<Utils::FixedPath>& names, const std::vector<Record>& trace)
+    {
+        std::ofstream file(tracePath, std::ios::binary | std::ios::trunc);
+        Header header = { traceMagic, traceVersion, traceTimeDateStamp, static_cast<u32>(names.size()), static_cast<u32>(trace.size()) };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const Utils::FixedPath& name : names) {
+            u16 length = static_cast<u16>(name.size());
+            file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file.write(reinterpret_cast<const char*>(name.c_str()), length * sizeof(wchar_t));
+        }
+        file.write(reinterpret_cast<const char*>(trace.data()), trace.size() * sizeof(Record));
+        return static_cast<bool>(file);
+    }
+
+    /**
+     * Reads every record back in order, the data itself is thrown away.
+     */
+    u64 replay(const std::vector<std::wstring>& names, const std::vector<Record>& trace)
+    {
+        std::wstring folder = gameFolder();
+        std::vector<HANDLE> files(names.size(), nullptr);
+        std::vector<u8> buffer(ReadTrace::maxMerge);
+        u64 bytes = 0;
+        for (const Record& record : trace) {
+            HANDLE& file = files[record.archive];
+            if (file == nullptr) {
+                file = CreateFileW((folder + names[record.archive]).c_str(), GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            }
+            if (file == INVALID_HANDLE_VALUE) {
+                continue;
+            }
+            LARGE_INTEGER offset;
+            offset.QuadPart = static_cast<LONGLONG>(record.offset);
+            if (!SetFilePointerEx(file, offset, nullptr, FILE_BEGIN)) {
+                continue;
+            }
+            for (u32 left = record.length; left > 0;) {
+                DWORD read = 0;
+                if (!ReadFile(file, buffer.data(), std::min<u32>(left, ReadTrace::maxMerge), &read, nullptr) || read == 0) {
+                    break;
+                }
+                left -= read;
+                bytes += read;
+            }
+        }
+        for (HANDLE file : files) {
+            if (file != nullptr && file != INVALID_HANDLE_VALUE) {
+                CloseHandle(file);
+            }
+        }
+        return bytes;
+    }
+
+    DWORD WINAPI traceThread(void*)
+    {
+        replayThread = true;
+        std::vector<std::wstring> names;
+        std::vector<Record> trace;
+        std::string error;
+        if (load(names, trace, error)) {
+            // Background mode lowers the I/O priority as well, the game's own reads go first
+            SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+            ULONGLONG begin = GetTickCount64();
+            u64 bytes = replay(names, trace);
+            SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+            LOG("Read trace: replayed {} records, {} MB from {} archives in {} ms",
+                trace.size(), bytes / (1024 * 1024), names.size(), GetTickCount64() - begin);
+        }
+        else {
+            LOG("Read trace: nothing replayed, {}", error);
+        }
+
+        ULONGLONG elapsed = GetTickCount64() - startTick;
+        if (elapsed < recordMs) {
+            Sleep(static_cast<DWORD>(recordMs - elapsed));
+        }
+        active.store(false, std::memory_order_relaxed);
+        std::lock_guard lock(recordMutex);
+        if (save(archives, records)) {
+            LOG("Read trace: recorded {} records, {} MB from {} archives to {}",
+                records.size(), recordedBytes / (1024 * 1024), archives.size(), tracePath);
+        }
+        else {
+            LOG("Read trace: failed to write {}", tracePath);
+        }
+        handles.fill({});
+        return 0;
+    }
+}
+
+namespace Utils
+{
+    void ReadTrace::start(const std::string& path, u32 timeDateStamp, u32 recordSeconds)
+    {
+        tracePath = path;
+        traceTimeDateStamp = timeDateStamp;
+        recordMs = recordSeconds * 1000;
+        startTick = GetTickCount64();
+        archives.reserve(maxArchives);
+        records.reserve(maxRecords);
+        active.store(true, std::memory_order_relaxed);
+        HANDLE traceHandle = CreateThread(nullptr, 0, traceThread, nullptr, 0, nullptr);
+        if (traceHandle) {
+            SetThreadPriority(traceHandle, THREAD_PRIORITY_LOWEST);
+            CloseHandle(traceHandle);
+        }
+        else {
+            active.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool ReadTrace::recording()
+    {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    void ReadTrace::record(HANDLE file, u64 offset, u32 length)
+    {
+        std::lock_guard lock(recordMutex);
+        if (!active.load(std::memory_order_relaxed) || length == 0) {
+            return;
+        }
+
+        auto it = std::find_if(handles.begin(), handles.end(), [file](const Handle& handle) { return handle.file == file; });
+        if (it == handles.end()) {
+            it = std::find_if(handles.begin(), handles.end(), [](const Handle& handle) { return handle.file == nullptr; });
+            if (it == handles.end()) {
+                return;
+            }
+            u32 index = noArchive;
+            Utils::FixedPath name = archiveName(file);
+            if (!name.empty()) {
+                auto known = std::find(archives.begin(), archives.end(), name);
+                index = static_cast<u32>(known - archives.begin());
+                if (known == archives.end() && archives.size() == maxArchives) {
+                    index = noArchive;
+                }
+                else if (known == archives.end()) {
+                    archives.push_back(name);
+                }
+            }
+            *it = { file, index };
+        }
+        u32 archive = it->archive;
+        if (archive == noArchive) {
+            return;
+        }
+
+        // The game streams in small chunks, a read continuing the last one extends it
+        if (!records.empty()) {
+            Record& last = records.back();
+            if (last.archive == archive && last.offset + last.length == offset && last.length + length <= maxMerge) {
+                last.length += length;
+                recordedBytes += length;
+                return;
+            }
+        }
+        if (records.size() >= maxRecords || recordedBytes + length > maxBytes) {
+            active.store(false, std::memory_order_relaxed);
+            return;
+        }
+        records.push_back({ archive, length, offset });
+        recordedBytes += length;
+    }
+
+    void ReadTrace::close(HANDLE file)
+    {
+        std::lock_guard lock(recordMutex);
+        for (Handle& handle : handles) {
+            if (handle.file == file) {
+                handle = {};
+            }
+        }
+    }
+
+    bool ReadTrace::isReplayThread()
+    {
+        return replayThread;
+    }
+}
@@ -0,0 +1,264 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Offline benchmark and validation of the signatures the mod ships with.
+ *
+ * @details
+ * Loads a GER.exe or GE2RB.exe from disk, maps its sections the way the Windows loader would and runs
+ * every signature in signatures.hpp through `Utils::patternScan` with each scan engine the CPU supports.
+ * Reports the RVAs each signature resolves to, whether it is still unique, whether every engine agrees
+ * with the scalar reference, whether each engine's first-hit scan agrees with its batch scan and the
+ * median and p99 scan time over a number of iterations.
+ *
+ * Usage: GodEater1-2Fix-sigbench <exe> [--iterations N] [--threads N] [--dumped]
+ *   --iterations  Scans per engine, 20 by default.
+ *   --threads     Threads for the batch scan, 1 by default, 0 uses all cores.
+ *   --dumped      The file is a memory dump of the running game, already laid out as mapped.
+ *
+ * Exits with 1 if a signature is missing or no longer unique or an engine disagrees, so it can gate a
+ * release against a new game update.
+ */
+
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+#include "signatures.hpp"
+
+namespace
+{
+    /**
+     * Lays out a PE file as it would be in memory, headers and each section's raw data at its
+     * virtual address. Imports and relocations are left alone, nothing runs from the image.
+     */
+    bool mapImage(const std::vector<u8>& file, bool dumped, std::vector<u8>& image, std::string& error)
+    {
+        if (file.size() < sizeof(IMAGE_DOS_HEADER)) {
+            error = "file too small for a DOS header";
+            return false;
+        }
+        auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(file.data());
+        if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE || dosHeader->e_lfanew < 0 ||
+            static_cast<size_t>(dosHeader->e_lfanew) + sizeof(IMAGE_NT_HEADERS32) > file.size()) {
+            error = "not a PE file";
+            return false;
+        }
+        auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS32*>(file.data() + dosHeader->e_lfanew);
+        if (ntHeaders->Signature != IMAGE_NT_SIGNATURE || ntHeaders->OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR32_MAGIC) {
+            error = "not a 32 bit PE file";
+            return false;
+        }
+
+        size_t sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+        if (dumped) {
+            image.assign(file.begin(), file.begin() + std::min(file.size(), sizeOfImage));
+            image.resize(sizeOfImage, 0);
+            return true;
+        }
+
+        image.assign(sizeOfImage, 0);
+        std::memcpy(image.data(), file.data(), std::min<size_t>({ ntHeaders->OptionalHeader.SizeOfHeaders, file.size(), sizeOfImage }));
+        auto sectionHeader = IMAGE_FIRST_SECTION(ntHeaders);
+        for (auto i = 0u; i < ntHeaders->FileHeader.NumberOfSections; ++i, ++sectionHeader) {
+            size_t raw = sectionHeader->PointerToRawData;
+            size_t virtualAddress = sectionHeader->VirtualAddress;
+            size_t size = sectionHeader->SizeOfRawData;
+            if (sectionHeader->Misc.VirtualSize != 0) {
+                size = std::min<size_t>(size, sectionHeader->Misc.VirtualSize);
+            }
+            if (raw >= file.size() || virtualAddress >= sizeOfImage) {
+                continue;
+            }
+            size = std::min({ size, file.size() - raw, sizeOfImage - virtualAddress });
+            std::memcpy(image.data() + virtualAddress, file.data() + raw, size);
+        }
+        return true;
+    }
+
+    /**
+     * Fresh copies of every signature, the originals keep no state from earlier scans.
+     */
+    std::vector<Utils::SignatureHook> freshSignatures()
+    {
+        std::vector<Utils::SignatureHook> copies;
+        for (Utils::SignatureHook* signature : allSignatures) {
+            Utils::SignatureHook copy = *signature;
+            copy.scanned = false;
+            copy.hits.clear();
+            copies.push_back(copy);
+        }
+        return copies;
+    }
+
+    double percentile(std::vector<double> samples, double fraction)
+    {
+        std::sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(samples.size())));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    }
+
+    const char* engineName(Utils::ScanEngine engine)
+    {
+        switch (engine) {
+        case Utils::ScanEngine::Scalar: return "scalar";
+        case Utils::ScanEngine::Sse2:   return "sse2";
+        case Utils::ScanEngine::Avx2:   return "avx2";
+        default:                        return "auto";
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string path;
+    u32 iterations = 20;
+    u32 threads = 1;
+    bool dumped = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--dumped") {
+            dumped = true;
+        }
+        else {
+            path = arg;
+        }
+    }
+    if (path.empty()) {
+        std::printf("Usage: %s <exe> [--iterations N] [--threads N] [--dumped]\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream input(path, std::ios::binary);
+    std::vector<u8> file((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    std::vector<u8> image;
+    std::string error;
+    if (file.empty() || !mapImage(file, dumped, image, error)) {
+        std::printf("Failed to load %s: %s\n", path.c_str(), error.empty() ? "can not read file" : error.c_str());
+        return 1;
+    }
+    void* base = image.data();
+    Utils::ModuleInfo module(reinterpret_cast<HMODULE>(base));
+    std::printf("%s: TimeDateStamp %08X, SizeOfImage %08X, CheckSum %08X\n",
+        path.c_str(), module.timeDateStamp, module.sizeOfImage, module.checkSum);
+
+    bool ok = true;
+    std::vector<std::vector<uintptr_t>> reference;
+    std::printf("\n%-8s %-8s %12s %12s\n", "engine", "mode", "median ms", "p99 ms");
+    for (Utils::ScanEngine engine : { Utils::ScanEngine::Scalar, Utils::ScanEngine::Sse2, Utils::ScanEngine::Avx2 }) {
+        if (!Utils::isScanEngineSupported(engine)) {
+            std::printf("%-8s not supported by this CPU\n", engineName(engine));
+            continue;
+        }
+        Utils::setScanEngine(engine);
+
+        std::vector<double> batchMs;
+        std::vector<double> singleMs;
+        std::vector<std::vector<uintptr_t>> hits;
+        for (u32 i = 0; i < iterations; ++i) {
+            std::vector<Utils::SignatureHook> signatures = freshSignatures();
+            std::vector<Utils::SignatureHook*> hooks;
+            for (Utils::SignatureHook& signature : signatures) {
+                hooks.push_back(&signature);
+            }
+
+            auto begin = std::chrono::steady_clock::now();
+            Utils::patternScan(base, hooks, threads);
+            auto end = std::chrono::steady_clock::now();
+            batchMs.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+
+            // The first-hit scan only covers executable sections, signatures with a hint are skipped
+            std::vector<uintptr_t> firstHits(signatures.size(), 0);
+            begin = std::chrono::steady_clock::now();
+            for (size_t s = 0; s < signatures.size(); ++s) {
+                if (signatures[s].section.empty()) {
+                    firstHits[s] = Utils::patternScan(base, signatures[s].signature);
+                }
+            }
+            end = std::chrono::steady_clock::now();
+            singleMs.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+
+            // The first-hit scan is what resolveHook and the early path use, it must agree with the batch
+            for (size_t s = 0; s < signatures.size(); ++s) {
+                const std::vector<uintptr_t>& batchHits = signatures[s].hits;
+                uintptr_t expected = batchHits.empty() ? 0 : batchHits.front();
+                if (signatures[s].section.empty() && firstHits[s] != expected) {
+                    ok = false;
+                    if (i != 0) {
+                        continue;
+                    }
+                    std::printf("%-8s single scan of %s hit %s, batch %s\n", engineName(engine), signatures[s].name.c_str(),
+                        firstHits[s] == 0 ? "nothing" : std::format("+{:x}", firstHits[s] - reinterpret_cast<uintptr_t>(base)).c_str(),
+                        expected == 0 ? "nothing" : std::format("+{:x}", expected - reinterpret_cast<uintptr_t>(base)).c_str());
+                }
+            }
+
+            if (i == 0) {
+                for (Utils::SignatureHook& signature : signatures) {
+                    hits.push_back(signature.hits);
+                }
+            }
+        }
+        std::printf("%-8s %-8s %12.3f %12.3f\n", engineName(engine), "batch", percentile(batchMs, 0.50), percentile(batchMs, 0.99));
+        std::printf("%-8s %-8s %12.3f %12.3f\n", engineName(engine), "single", percentile(singleMs, 0.50), percentile(singleMs, 0.99));
+
+        if (reference.empty()) {
+            reference = hits;
+        }
+        else if (hits != reference) {
+            std::printf("%-8s hits differ from %s\n", engineName(engine), engineName(Utils::ScanEngine::Scalar));
+            ok = false;
+        }
+    }
+    Utils::setScanEngine(Utils::ScanEngine::Auto);
+
+    std::printf("\n");
+    for (size_t i = 0; i < allSignatures.size(); ++i) {
+        const Utils::SignatureHook& signature = *allSignatures[i];
+        const std::vector<uintptr_t>& found = reference[i];
+        const char* status = found.empty() ? "MISSING" : found.size() == 1 ? "unique" : "NOT UNIQUE";
+        ok = ok && found.size() == 1;
+        std::string rvas;
+        for (uintptr_t hit : found) {
+            rvas += std::format(" +{:x}", hit - reinterpret_cast<uintptr_t>(base) + static_cast<uintptr_t>(signature.offset));
+        }
+        std::printf("%-20s %-10s %zu hits%s\n", signature.name.c_str(), status, found.size(), rvas.c_str());
+    }
+    return ok ? 0 : 1;
+}
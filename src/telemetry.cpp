@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <algorithm>
+#include <format>
+#include <fstream>
+
+#include "telemetry.hpp"
+
+namespace
+{
+    i64 now()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    /**
+     * How often the hotkey is polled and how long a stopped capture is given to settle.
+     */
+    constexpr DWORD pollMs = 50;
+    constexpr DWORD settleMs = 100;
+}
+
+namespace Utils
+{
+    void FrameTelemetry::beginFrame()
+    {
+        if (!capturing()) {
+            frameBegin = 0;
+            previousBegin = 0;
+            return;
+        }
+        frameBegin = now();
+        paced = frameBegin;
+        if (previousBegin == 0) {
+            captureBegin = frameBegin;
+        }
+    }
+
+    void FrameTelemetry::pacedFrame()
+    {
+        if (frameBegin != 0) {
+            paced = now();
+        }
+    }
+
+    void FrameTelemetry::endFrame(u32 movie, u32 hudHits)
+    {
+        if (frameBegin == 0) {
+            return;
+        }
+        i64 end = now();
+        // The first frame of a capture only starts the clock
+        if (previousBegin != 0) {
+            auto ms = [this](i64 ticks) { return static_cast<f32>(static_cast<f64>(ticks) * 1000.0 / static_cast<f64>(frequency)); };
+            u64 index = count.load(std::memory_order_relaxed);
+            frames[index % capacity] = {
+                frameBegin - captureBegin,
+                ms(frameBegin - previousBegin),
+                ms(frameBegin - previousEnd),
+                ms(paced - frameBegin),
+                ms(end - paced),
+                hudHits,
+                movie
+            };
+            count.store(index + 1, std::memory_order_release);
+        }
+        previousBegin = frameBegin;
+        previousEnd = end;
+    }
+
+    void FrameTelemetry::startHotkey(u32 key, const std::string& csvPath)
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceFrequency(&counter);
+        frequency = counter.QuadPart;
+        virtualKey = key;
+        path = csvPath;
+        HANDLE hotkeyHandle = CreateThread(nullptr, 0, hotkeyThread, this, 0, nullptr);
+        if (hotkeyHandle) {
+            SetThreadPriority(hotkeyHandle, THREAD_PRIORITY_LOWEST);
+            CloseHandle(hotkeyHandle);
+        }
+    }
+
+    DWORD WINAPI FrameTelemetry::hotkeyThread(void* parameter)
+    {
+        auto telemetry = static_cast<FrameTelemetry*>(parameter);
+        bool wasDown = false;
+        while (true) {
+            Sleep(pollMs);
+            bool down = (GetAsyncKeyState(static_cast<int>(telemetry->virtualKey)) & 0x8000) != 0;
+            if (down && !wasDown) {
+                if (!telemetry->capturing()) {
+                    telemetry->count.store(0, std::memory_order_relaxed);
+                    telemetry->active.store(true, std::memory_order_release);
+                    LOG("Telemetry capture started");
+                }
+                else {
+                    telemetry->active.store(false, std::memory_order_relaxed);
+                    Sleep(settleMs);
+                    if (telemetry->write()) {
+                        LOG("Telemetry capture of {} frames written to {}",
+                            std::min<u64>(telemetry->count.load(std::memory_order_acquire), capacity), telemetry->path);
+                    }
+                    else {
+                        LOG("Failed to write telemetry capture {}", telemetry->path);
+                    }
+                }
+            }
+            wasDown = down;
+        }
+        return 0;
+    }
+
+    bool FrameTelemetry::write() const
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << "frame,time_ms,frame_ms,cpu_ms,wait_ms,present_ms,movie,hud_hits\n";
+        u64 total = count.load(std::memory_order_acquire);
+        u64 first = total > capacity ? total - capacity : 0;
+        for (u64 i = first; i < total; ++i) {
+            const Frame& frame = frames[i % capacity];
+            f64 timeMs = static_cast<f64>(frame.begin) * 1000.0 / static_cast<f64>(frequency);
+            file << std::format("{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{},{}\n",
+                i, timeMs, frame.frameMs, frame.cpuMs, frame.waitMs, frame.presentMs, frame.movie, frame.hudHits);
+        }
+        return static_cast<bool>(file);
+    }
+}
@@ -0,0 +1,287 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <tlhelp32.h>
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+#include "threadmanager.hpp"
+
+namespace
+{
+    using NtQueryInformationThreadFn = LONG(WINAPI*)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+    using GetSystemCpuSetInformationFn = BOOL(WINAPI*)(PSYSTEM_CPU_SET_INFORMATION, ULONG, PULONG, HANDLE, ULONG);
+    using SetThreadSelectedCpuSetsFn = BOOL(WINAPI*)(HANDLE, const ULONG*, ULONG);
+    using SetThreadInformationFn = BOOL(WINAPI*)(HANDLE, THREAD_INFORMATION_CLASS, LPVOID, DWORD);
+
+    // THREADINFOCLASS value of the thread's start address, as passed to CreateThread
+    constexpr ULONG threadQuerySetWin32StartAddress = 9;
+
+    // Marks threads that have no role, so their start address is only looked up once
+    constexpr u8 noRole = 0xFF;
+
+    NtQueryInformationThreadFn ntQueryInformationThread = nullptr;
+    SetThreadSelectedCpuSetsFn setThreadSelectedCpuSets = nullptr;
+    SetThreadInformationFn setThreadInformation = nullptr;
+
+    constexpr std::array<const char*, 4> roleNames = { "render", "streaming", "movie", "worker" };
+
+    /**
+     * Hybrid CPUs have more than one efficiency class, the highest one are the performance cores.
+     * Both stay empty when the CPU sets can not be listed.
+     */
+    void loadCpuSets(HMODULE kernel32, std::vector<ULONG>& performance, std::vector<ULONG>& efficiency)
+    {
+        auto getSystemCpuSetInformation = kernel32 ?
+            reinterpret_cast<GetSystemCpuSetInformationFn>(GetProcAddress(kernel32, "GetSystemCpuSetInformation")) : nullptr;
+        if (getSystemCpuSetInformation == nullptr) {
+            return;
+        }
+        ULONG length = 0;
+        getSystemCpuSetInformation(nullptr, 0, &length, GetCurrentProcess(), 0);
+        std::vector<u8> buffer(length);
+        if (length == 0 || !getSystemCpuSetInformation(reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data()), length, &length, GetCurrentProcess(), 0)) {
+            return;
+        }
+
+        std::vector<std::pair<ULONG, BYTE>> sets;
+        for (ULONG offset = 0; offset < length;) {
+            auto entry = reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data() + offset);
+            if (entry->Size == 0) {
+                break;
+            }
+            if (entry->Type == CpuSetInformation) {
+                sets.push_back({ entry->CpuSet.Id, entry->CpuSet.EfficiencyClass });
+            }
+            offset += entry->Size;
+        }
+        if (sets.empty()) {
+            return;
+        }
+        auto [lowest, highest] = std::minmax_element(sets.begin(), sets.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+        for (const auto& [id, efficiencyClass] : sets) {
+            if (efficiencyClass == highest->second) {
+                performance.push_back(id);
+            }
+            if (efficiencyClass == lowest->second) {
+                efficiency.push_back(id);
+            }
+        }
+    }
+
+    HMODULE moduleOf(const void* address)
+    {
+        HMODULE module = nullptr;
+        GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+            static_cast<LPCWSTR>(address), &module);
+        return module;
+    }
+
+    HMODULE startModule(DWORD id)
+    {
+        if (ntQueryInformationThread == nullptr) {
+            return nullptr;
+        }
+        HANDLE thread = OpenThread(THREAD_QUERY_INFORMATION, FALSE, id);
+        if (thread == nullptr) {
+            return nullptr;
+        }
+        void* start = nullptr;
+        LONG status = ntQueryInformationThread(thread, threadQuerySetWin32StartAddress, &start, sizeof(start), nullptr);
+        CloseHandle(thread);
+        return status >= 0 ? moduleOf(start) : nullptr;
+    }
+}
+
+namespace Utils
+{
+    ThreadManager::Rule ThreadManager::parseRule(const std::string& priority, const std::string& cores, const std::string& qos)
+    {
+        constexpr std::array<std::pair<std::string_view, int>, 7> priorities = {{
+            { "idle", THREAD_PRIORITY_IDLE },
+            { "lowest", THREAD_PRIORITY_LOWEST },
+            { "below_normal", THREAD_PRIORITY_BELOW_NORMAL },
+            { "normal", THREAD_PRIORITY_NORMAL },
+            { "above_normal", THREAD_PRIORITY_ABOVE_NORMAL },
+            { "highest", THREAD_PRIORITY_HIGHEST },
+            { "time_critical", THREAD_PRIORITY_TIME_CRITICAL },
+        }};
+
+        Rule rule;
+        auto found = std::find_if(priorities.begin(), priorities.end(), [&](const auto& entry) { return entry.first == priority; });
+        if (found != priorities.end()) {
+            rule.setPriority = true;
+            rule.priority = found->second;
+        }
+        else if (priority != "unchanged") {
+            LOG("Unknown thread priority '{}', left unchanged", priority);
+        }
+
+        if (cores == "all") {
+            rule.cores = Cores::All;
+        }
+        else if (cores == "performance") {
+            rule.cores = Cores::Performance;
+        }
+        else if (cores == "efficiency") {
+            rule.cores = Cores::Efficiency;
+        }
+        else if (cores != "unchanged") {
+            LOG("Unknown thread cores '{}', left unchanged", cores);
+        }
+
+        if (qos == "high") {
+            rule.qos = Qos::High;
+        }
+        else if (qos == "eco") {
+            rule.qos = Qos::Eco;
+        }
+        else if (qos != "unchanged") {
+            LOG("Unknown thread qos '{}', left unchanged", qos);
+        }
+        return rule;
+    }
+
+    void ThreadManager::setRule(Role role, const Rule& rule)
+    {
+        rules[static_cast<size_t>(role)] = rule;
+    }
+
+    void ThreadManager::start(u32 interval)
+    {
+        intervalMs = interval;
+        HMODULE ntdll = GetModuleHandleA("ntdll.dll");
+        HMODULE kernel32 = GetModuleHandleA("kernel32.dll");
+        if (ntdll) {
+            ntQueryInformationThread = reinterpret_cast<NtQueryInformationThreadFn>(GetProcAddress(ntdll, "NtQueryInformationThread"));
+        }
+        if (kernel32) {
+            setThreadSelectedCpuSets = reinterpret_cast<SetThreadSelectedCpuSetsFn>(GetProcAddress(kernel32, "SetThreadSelectedCpuSets"));
+            setThreadInformation = reinterpret_cast<SetThreadInformationFn>(GetProcAddress(kernel32, "SetThreadInformation"));
+        }
+
+        loadCpuSets(kernel32, performanceSets, efficiencySets);
+        LOG("Thread manager: {} performance and {} efficiency cores{}", performanceSets.size(), efficiencySets.size(),
+            performanceSets.size() == efficiencySets.size() ? ", not a hybrid CPU" : "");
+
+        HANDLE managerHandle = CreateThread(nullptr, 0, managerThread, this, 0, nullptr);
+        if (managerHandle) {
+            SetThreadPriority(managerHandle, THREAD_PRIORITY_LOWEST);
+            CloseHandle(managerHandle);
+        }
+    }
+
+    DWORD WINAPI ThreadManager::managerThread(void* parameter)
+    {
+        auto manager = static_cast<ThreadManager*>(parameter);
+        while (true) {
+            manager->scan();
+            Sleep(manager->intervalMs);
+        }
+        return 0;
+    }
+
+    void ThreadManager::scan()
+    {
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+        if (snapshot == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        HMODULE game = GetModuleHandleW(nullptr);
+        HMODULE quartz = GetModuleHandleA("quartz.dll");
+        DWORD process = GetCurrentProcessId();
+        DWORD render = renderThread.load(std::memory_order_relaxed);
+
+        std::unordered_map<DWORD, u8> alive;
+        THREADENTRY32 entry = {};
+        entry.dwSize = sizeof(entry);
+        for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry)) {
+            if (entry.th32OwnerProcessID != process) {
+                continue;
+            }
+            DWORD id = entry.th32ThreadID;
+            auto known = applied.find(id);
+            u8 role = known != applied.end() ? known->second : noRole;
+            bool streaming = std::any_of(streamingThreads.begin(), streamingThreads.end(),
+                [id](const std::atomic<DWORD>& slot) { return slot.load(std::memory_order_relaxed) == id; });
+            if (id == render) {
+                role = static_cast<u8>(Role::Render);
+            }
+            else if (streaming) {
+                role = static_cast<u8>(Role::Streaming);
+            }
+            else if (known == applied.end()) {
+                HMODULE start = startModule(id);
+                if (start != nullptr && start == quartz) {
+                    role = static_cast<u8>(Role::Movie);
+                }
+                else if (start != nullptr && start == game) {
+                    role = static_cast<u8>(Role::Worker);
+                }
+            }
+
+            if (role != noRole && (known == applied.end() || known->second != role)) {
+                apply(id, static_cast<Role>(role));
+            }
+            alive.emplace(id, role);
+        }
+        CloseHandle(snapshot);
+        applied = std::move(alive);
+    }
+
+    void ThreadManager::apply(DWORD id, Role role)
+    {
+        const Rule& rule = rules[static_cast<size_t>(role)];
+        HANDLE thread = OpenThread(THREAD_SET_INFORMATION | THREAD_SET_LIMITED_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, id);
+        if (thread == nullptr) {
+            return;
+        }
+
+        if (rule.setPriority) {
+            SetThreadPriority(thread, rule.priority);
+        }
+
+        // All clears the selection, the thread may run anywhere again
+        const std::vector<ULONG>& sets = rule.cores == Cores::Performance ? performanceSets : efficiencySets;
+        if (setThreadSelectedCpuSets && rule.cores == Cores::All) {
+            setThreadSelectedCpuSets(thread, nullptr, 0);
+        }
+        else if (setThreadSelectedCpuSets && rule.cores != Cores::Unchanged && !sets.empty()) {
+            setThreadSelectedCpuSets(thread, sets.data(), static_cast<ULONG>(sets.size()));
+        }
+
+        if (setThreadInformation && rule.qos != Qos::Unchanged) {
+            THREAD_POWER_THROTTLING_STATE state = {};
+            state.Version = THREAD_POWER_THROTTLING_CURRENT_VERSION;
+            state.ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED;
+            state.StateMask = rule.qos == Qos::Eco ? THREAD_POWER_THROTTLING_EXECUTION_SPEED : 0;
+            setThreadInformation(thread, ThreadPowerThrottling, &state, sizeof(state));
+        }
+        CloseHandle(thread);
+        LOG("Thread {} is {}, rule applied", id, roleNames[static_cast<size_t>(role)]);
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "trace.hpp"
+
+namespace
+{
+    struct Event {
+        std::string name;
+        double beginUs;
+        double endUs;
+        DWORD threadId;
+    };
+
+    std::mutex eventsMutex;
+    std::vector<Event> events;
+
+    /**
+     * QPC ticks per second and the QPC value the process was created at, the creation time is
+     * only known as a FILETIME so it is mapped onto QPC through the current time of both.
+     */
+    struct Clock {
+        double ticksPerUs;
+        LONGLONG processStart;
+
+        Clock()
+        {
+            LARGE_INTEGER frequency, now;
+            QueryPerformanceFrequency(&frequency);
+            QueryPerformanceCounter(&now);
+            ticksPerUs = static_cast<double>(frequency.QuadPart) / 1'000'000.0;
+
+            FILETIME creation, exit, kernel, user, current;
+            GetSystemTimePreciseAsFileTime(&current);
+            processStart = now.QuadPart;
+            if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+                auto toU64 = [](const FILETIME& time) {
+                    return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+                };
+                // FILETIME counts 100 ns intervals
+                double sinceCreationUs = static_cast<double>(toU64(current) - toU64(creation)) / 10.0;
+                processStart -= static_cast<LONGLONG>(sinceCreationUs * ticksPerUs);
+            }
+        }
+
+        double nowUs() const
+        {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            return static_cast<double>(now.QuadPart - processStart) / ticksPerUs;
+        }
+    };
+
+    const Clock& traceClock()
+    {
+        static const Clock instance;
+        return instance;
+    }
+
+    std::string escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
+namespace Utils
+{
+    double Trace::msSinceProcessStart()
+    {
+        return traceClock().nowUs() / 1000.0;
+    }
+
+    void Trace::add(std::string name, double beginUs, double endUs)
+    {
+        DWORD threadId = GetCurrentThreadId();
+        std::lock_guard lock(eventsMutex);
+        events.push_back({ std::move(name), beginUs, endUs, threadId });
+    }
+
+    bool Trace::write(const std::string& path)
+    {
+        std::lock_guard lock(eventsMutex);
+        std::ofstream file(path, std::ios::trunc);
+        DWORD processId = GetCurrentProcessId();
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for (size_t i = 0; i < events.size(); ++i) {
+            const Event& event = events[i];
+            file << std::format("{{\"name\":\"{}\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{}}}{}\n",
+                escape(event.name), event.beginUs, event.endUs - event.beginUs, processId, event.threadId,
+                i + 1 < events.size() ? "," : "");
+        }
+        file << "]}\n";
+        return static_cast<bool>(file);
+    }
+
+    TraceScope::TraceScope(std::string name) : name(std::move(name)), beginUs(traceClock().nowUs()) {}
+
+    TraceScope::~TraceScope()
+    {
+        Trace::add(std::move(name), beginUs, traceClock().nowUs());
+    }
+}
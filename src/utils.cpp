@@ -30,8 +30,344 @@
 #include <span>
 #include <cstdint>
 #include <algorithm>
+#include <cctype>
+#include <bit>
+#include <array>
+#include <fstream>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include "utils.hpp"
+#include "known_builds.hpp"
+#include "trace.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define UTILS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UTILS_TARGET_AVX2
+#endif
+
+namespace
+{
+    bool hasAvx2()
+    {
+        static const bool supported = [] {
+#if defined(_MSC_VER)
+            int regs[4] = {};
+            __cpuid(regs, 0);
+            if (regs[0] < 7) {
+                return false;
+            }
+            __cpuid(regs, 1);
+            bool osxsave = (regs[2] & (1 << 27)) != 0;
+            bool avx = (regs[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+                return false;
+            }
+            __cpuidex(regs, 7, 0);
+            return (regs[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2") != 0;
+#endif
+        }();
+        return supported;
+    }
+
+    Utils::ScanEngine scanEngine = Utils::ScanEngine::Auto;
+
+    /**
+     * The engine `patternScan` runs with, AVX2 is only used if the CPU has it.
+     */
+    Utils::ScanEngine activeEngine()
+    {
+        if (scanEngine == Utils::ScanEngine::Scalar || scanEngine == Utils::ScanEngine::Sse2) {
+            return scanEngine;
+        }
+        return hasAvx2() ? Utils::ScanEngine::Avx2 : Utils::ScanEngine::Sse2;
+    }
+
+    inline bool matches(const u8* bytes, const Utils::Signature& signature)
+    {
+        for (size_t j = 0; j < signature.size; ++j) {
+            if ((bytes[j] ^ signature.bytes[j]) & signature.mask[j]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const u8* scanScalar(const u8* base, size_t count, const Utils::Signature& signature)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            if (matches(base + i, signature)) {
+                return base + i;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Compares 16 candidate offsets per iteration against both anchor bytes and only runs the full
+     * masked compare on offsets where both anchors hit. Loads never go past `base + count + size - 1`.
+     */
+    const u8* scanSse2(const u8* base, size_t count, const Utils::Signature& signature)
+    {
+        const __m128i needle0 = _mm_set1_epi8(static_cast<char>(signature.bytes[signature.anchor0]));
+        const __m128i needle1 = _mm_set1_epi8(static_cast<char>(signature.bytes[signature.anchor1]));
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i block0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i + signature.anchor0));
+            __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i + signature.anchor1));
+            u32 mask = static_cast<u32>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(block0, needle0), _mm_cmpeq_epi8(block1, needle1))
+            ));
+            while (mask != 0) {
+                const u8* candidate = base + i + std::countr_zero(mask);
+                if (matches(candidate, signature)) {
+                    return candidate;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return scanScalar(base + i, count - i, signature);
+    }
+
+    /**
+     * AVX2 variant of `scanSse2`, 32 candidate offsets per iteration.
+     */
+    UTILS_TARGET_AVX2
+    const u8* scanAvx2(const u8* base, size_t count, const Utils::Signature& signature)
+    {
+        const __m256i needle0 = _mm256_set1_epi8(static_cast<char>(signature.bytes[signature.anchor0]));
+        const __m256i needle1 = _mm256_set1_epi8(static_cast<char>(signature.bytes[signature.anchor1]));
+
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i block0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i + signature.anchor0));
+            __m256i block1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i + signature.anchor1));
+            u32 mask = static_cast<u32>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(block0, needle0), _mm256_cmpeq_epi8(block1, needle1))
+            ));
+            while (mask != 0) {
+                const u8* candidate = base + i + std::countr_zero(mask);
+                if (matches(candidate, signature)) {
+                    return candidate;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return scanSse2(base + i, count - i, signature);
+    }
+
+    /**
+     * Resolved signatures of the current and previous runs, keyed by `cacheKey`.
+     */
+    struct CacheEntry {
+        std::string identity;
+        std::string signature;
+        u32 rva;
+    };
+
+    struct SignatureCache {
+        std::string path;
+        std::unordered_map<std::string, CacheEntry> entries;
+    } signatureCache;
+
+    std::string exeIdentity(const Utils::ModuleInfo& module)
+    {
+        return std::format("{} {:08X} {:08X} {:08X}",
+            module.name, module.timeDateStamp, module.sizeOfImage, module.checkSum
+        );
+    }
+
+    bool sameExe(std::string_view a, std::string_view b)
+    {
+        return std::ranges::equal(a, b, [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    bool sameBuild(const KnownBuilds::Entry& entry, const Utils::ModuleInfo& module)
+    {
+        return sameExe(entry.exe, module.name)
+            && entry.timeDateStamp == module.timeDateStamp
+            && entry.checkSum == module.checkSum;
+    }
+
+    /**
+     * Checks the bytes at `rva` still match the signature, this guards against stale cache
+     * entries the identity check did not catch.
+     */
+    bool verifyAt(const Utils::ModuleInfo& module, u32 rva, const Utils::Signature& signature)
+    {
+        if (rva >= module.sizeOfImage || signature.size > module.sizeOfImage - rva) {
+            return false;
+        }
+        return matches(reinterpret_cast<const u8*>(module.address) + rva, signature);
+    }
+
+    /**
+     * Upper bound of distinct anchor bytes filtered with SIMD, past this the dispatch table is
+     * walked for every byte instead.
+     */
+    constexpr size_t maxSimdAnchors = 16;
+
+    /**
+     * One signature taking part in a batch scan, anchored on its rarest non-wildcard byte.
+     * `count` is the number of valid start offsets in the scanned section and `index` its
+     * position in the batch.
+     */
+    struct BatchEntry {
+        const Utils::Signature* signature;
+        size_t count;
+        size_t index;
+    };
+
+    /**
+     * Anchor byte value to every (entry, anchor index) waiting on it, so each byte in memory is
+     * looked at once no matter how many signatures are being scanned for.
+     */
+    struct DispatchTable {
+        std::array<std::vector<std::pair<const BatchEntry*, size_t>>, 256> candidates;
+        std::vector<u8> anchorBytes;
+    };
+
+    /**
+     * Smallest slice of a section worth handing to its own thread.
+     */
+    constexpr size_t minChunkSize = 1024 * 1024;
+
+    /**
+     * A slice of a section scanned by one thread. The chunk owns the start offsets
+     * [startBegin, startEnd) and reads memory up to `end`, which is past `startEnd` by the
+     * longest signature - 1 so matches starting close to the edge are still seen. Matches
+     * starting outside the owned range are left to the neighbouring chunk. Hits are kept
+     * per batch entry and merged in chunk order afterwards.
+     */
+    struct ScanChunk {
+        const u8* base;
+        size_t startBegin;
+        size_t startEnd;
+        size_t end;
+        std::vector<std::vector<uintptr_t>> hits;
+    };
+
+    /**
+     * One section of a batch scan: the signatures wanted in it, their dispatch table and the
+     * chunks it is split into. The table points into `entries`, a scan is not moved once built.
+     */
+    struct SectionScan {
+        std::vector<BatchEntry> entries;
+        DispatchTable table;
+        std::vector<ScanChunk> chunks;
+    };
+
+    /**
+     * Runs every signature waiting on the byte at `base + position`. Offsets are visited in
+     * ascending order so each signature's hits end up sorted by address.
+     */
+    inline void dispatch(ScanChunk& chunk, size_t position, const DispatchTable& table)
+    {
+        for (auto& [entry, anchor] : table.candidates[chunk.base[position]]) {
+            if (position < anchor) {
+                continue;
+            }
+            size_t start = position - anchor;
+            if (start < chunk.startBegin || start >= chunk.startEnd || start >= entry->count) {
+                continue;
+            }
+            if (matches(chunk.base + start, *entry->signature)) {
+                chunk.hits[entry->index].push_back(reinterpret_cast<uintptr_t>(chunk.base + start));
+            }
+        }
+    }
+
+    void scanBatchScalar(ScanChunk& chunk, size_t begin, const DispatchTable& table)
+    {
+        for (size_t i = begin; i < chunk.end; ++i) {
+            if (!table.candidates[chunk.base[i]].empty()) {
+                dispatch(chunk, i, table);
+            }
+        }
+    }
+
+    /**
+     * OR's together the compares against every distinct anchor byte so only bytes that some
+     * signature anchors on reach the dispatch table.
+     */
+    void scanBatchSse2(ScanChunk& chunk, const DispatchTable& table)
+    {
+        __m128i needles[maxSimdAnchors];
+        size_t needleCount = table.anchorBytes.size();
+        for (size_t n = 0; n < needleCount; ++n) {
+            needles[n] = _mm_set1_epi8(static_cast<char>(table.anchorBytes[n]));
+        }
+
+        size_t i = chunk.startBegin;
+        for (; i + 16 <= chunk.end; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunk.base + i));
+            __m128i any = _mm_setzero_si128();
+            for (size_t n = 0; n < needleCount; ++n) {
+                any = _mm_or_si128(any, _mm_cmpeq_epi8(block, needles[n]));
+            }
+            u32 mask = static_cast<u32>(_mm_movemask_epi8(any));
+            while (mask != 0) {
+                dispatch(chunk, i + std::countr_zero(mask), table);
+                mask &= mask - 1;
+            }
+        }
+        scanBatchScalar(chunk, i, table);
+    }
+
+    /**
+     * AVX2 variant of `scanBatchSse2`.
+     */
+    UTILS_TARGET_AVX2
+    void scanBatchAvx2(ScanChunk& chunk, const DispatchTable& table)
+    {
+        __m256i needles[maxSimdAnchors];
+        size_t needleCount = table.anchorBytes.size();
+        for (size_t n = 0; n < needleCount; ++n) {
+            needles[n] = _mm256_set1_epi8(static_cast<char>(table.anchorBytes[n]));
+        }
+
+        size_t i = chunk.startBegin;
+        for (; i + 32 <= chunk.end; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chunk.base + i));
+            __m256i any = _mm256_setzero_si256();
+            for (size_t n = 0; n < needleCount; ++n) {
+                any = _mm256_or_si256(any, _mm256_cmpeq_epi8(block, needles[n]));
+            }
+            u32 mask = static_cast<u32>(_mm256_movemask_epi8(any));
+            while (mask != 0) {
+                dispatch(chunk, i + std::countr_zero(mask), table);
+                mask &= mask - 1;
+            }
+        }
+        scanBatchScalar(chunk, i, table);
+    }
+
+    void scanChunk(ScanChunk& chunk, const DispatchTable& table)
+    {
+        Utils::TraceScope trace("scanChunk");
+        Utils::ScanEngine engine = activeEngine();
+        if (table.anchorBytes.size() > maxSimdAnchors || engine == Utils::ScanEngine::Scalar) {
+            scanBatchScalar(chunk, chunk.startBegin, table);
+        }
+        else if (engine == Utils::ScanEngine::Avx2) {
+            scanBatchAvx2(chunk, table);
+        }
+        else {
+            scanBatchSse2(chunk, table);
+        }
+    }
+}
 
 namespace Utils
 {
@@ -78,77 +414,303 @@ namespace Utils
         return {};
     }
 
-    void patch(u64 address, std::string_view pattern) {
-        static auto patternToByte = [](std::string_view pattern) {
-            std::vector<u8> bytes;
-            std::istringstream stream(pattern.data());
-            std::string byteStr;
-
-            while (stream >> byteStr) {  // Extract space-separated hex values
-                bytes.push_back(static_cast<u8>(std::stoul(byteStr, nullptr, 16)));
+    void patch(u64 address, const Signature& pattern) {
+        DWORD oldProtect;
+        auto bytes = reinterpret_cast<u8*>(address);
+        VirtualProtect((LPVOID)address, pattern.size, PAGE_EXECUTE_READWRITE, &oldProtect);
+        for (size_t i = 0; i < pattern.size; ++i) {
+            if (pattern.mask[i] != 0) {
+                bytes[i] = pattern.bytes[i];
             }
-            return bytes;
-        };
+        }
+        VirtualProtect((LPVOID)address, pattern.size, oldProtect, &oldProtect);
+    }
 
+    void patch(u64 address, std::span<const u8> bytes) {
         DWORD oldProtect;
-        auto patternBytes = patternToByte(pattern);
-        VirtualProtect((LPVOID)address, patternBytes.size(), PAGE_EXECUTE_READWRITE, &oldProtect);
-        memcpy((LPVOID)address, patternBytes.data(), patternBytes.size());
-        VirtualProtect((LPVOID)address, patternBytes.size(), oldProtect, &oldProtect);
+        VirtualProtect((LPVOID)address, bytes.size(), PAGE_EXECUTE_READWRITE, &oldProtect);
+        std::copy(bytes.begin(), bytes.end(), reinterpret_cast<u8*>(address));
+        VirtualProtect((LPVOID)address, bytes.size(), oldProtect, &oldProtect);
+    }
+
+    std::vector<Section> getSections(void* module)
+    {
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((u8*)module + dosHeader->e_lfanew);
+        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+        auto sectionHeader = IMAGE_FIRST_SECTION(ntHeaders);
+
+        std::vector<Section> sections;
+        for (auto i = 0u; i < ntHeaders->FileHeader.NumberOfSections; ++i, ++sectionHeader) {
+            auto name = reinterpret_cast<const char*>(sectionHeader->Name);
+            auto virtualAddress = sectionHeader->VirtualAddress;
+            auto size = sectionHeader->Misc.VirtualSize != 0
+                ? sectionHeader->Misc.VirtualSize
+                : sectionHeader->SizeOfRawData;
+            if (virtualAddress >= sizeOfImage) {
+                continue;
+            }
+            size = std::min<u32>(size, sizeOfImage - virtualAddress);
+
+            Section section = {};
+            section.name = std::string(name, strnlen(name, IMAGE_SIZEOF_SHORT_NAME));
+            section.begin = reinterpret_cast<const u8*>(module) + virtualAddress;
+            section.size = size;
+            section.executable = (sectionHeader->Characteristics & IMAGE_SCN_MEM_EXECUTE) != 0;
+            sections.push_back(section);
+        }
+        std::sort(sections.begin(), sections.end(), [](const Section& a, const Section& b) {
+            return a.begin < b.begin;
+        });
+        return sections;
+    }
+
+    void setScanEngine(ScanEngine engine)
+    {
+        scanEngine = engine;
+    }
+
+    bool isScanEngineSupported(ScanEngine engine)
+    {
+        return engine != ScanEngine::Avx2 || hasAvx2();
     }
 
-    uintptr_t patternScan(void* module, std::string& signature)
+    uintptr_t patternScan(void* module, const Signature& signature)
     {
-        static auto pattern_to_byte = [](const char* pattern) {
-            struct Pattern {
-                std::vector<u8> bytes;
-                std::vector<u8> check;
-            };
-            auto start = const_cast<char*>(pattern);
-            auto end = const_cast<char*>(pattern) + strlen(pattern);
+        Utils::TraceScope trace(std::format("patternScan '{}'", signature.text));
+        auto size = signature.size;
+
+        for (const Section& section : getSections(module)) {
+            if (!section.executable || size >= section.size) {
+                continue;
+            }
 
-            Pattern pat = {};
-            for (auto current = start; current < end; ++current) {
-                if (*current == ' ') {
+            // Every offset in [0, section.size - size) is a candidate start
+            auto count = section.size - size;
+            const u8* hit = nullptr;
+            Utils::ScanEngine engine = activeEngine();
+            if (signature.anchor0 == size || engine == Utils::ScanEngine::Scalar) {
+                hit = scanScalar(section.begin, count, signature);
+            }
+            else if (engine == Utils::ScanEngine::Avx2) {
+                hit = scanAvx2(section.begin, count, signature);
+            }
+            else {
+                hit = scanSse2(section.begin, count, signature);
+            }
+            if (hit != nullptr) {
+                return reinterpret_cast<uintptr_t>(hit);
+            }
+        }
+        return 0;
+    }
+
+    void patternScan(void* module, std::span<SignatureHook*> hooks, u32 threads)
+    {
+        std::string traceName = "patternScan";
+        for (SignatureHook* hook : hooks) {
+            traceName += " " + (hook->name.empty() ? std::string(hook->signature.text) : hook->name);
+        }
+        Utils::TraceScope trace(traceName);
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (SignatureHook* hook : hooks) {
+            hook->hits.clear();
+            hook->scanned = true;
+        }
+
+        // Every section is prepared first so one set of workers takes chunks of all of them
+        std::vector<Section> sections = getSections(module);
+        std::vector<SectionScan> scans;
+        scans.reserve(sections.size());
+        std::vector<std::pair<SectionScan*, size_t>> work;
+        for (const Section& section : sections) {
+            SectionScan& scan = scans.emplace_back();
+            scan.entries.reserve(hooks.size());
+            size_t longest = 0;
+            for (size_t index = 0; index < hooks.size(); ++index) {
+                const std::string& hint = hooks[index]->section;
+                bool wanted = hint.empty() ? section.executable : hint == section.name;
+                auto size = hooks[index]->signature.size;
+                if (!wanted || size >= section.size) {
                     continue;
                 }
-                else if (*current == '?') {
-                    current += 2;
-                    pat.bytes.push_back(0xFF);
-                    pat.check.push_back(0);
+                BatchEntry& entry = scan.entries.emplace_back(BatchEntry{ &hooks[index]->signature, section.size - size, index });
+
+                auto anchor = entry.signature->anchor0;
+                if (anchor == size) {
+                    // Nothing to anchor on, every start offset matches
+                    for (size_t i = 0; i < entry.count; ++i) {
+                        hooks[index]->hits.push_back(reinterpret_cast<uintptr_t>(section.begin + i));
+                    }
+                    continue;
                 }
-                else {
-                    pat.bytes.push_back(strtoul(current, &current, 16));
-                    pat.check.push_back(1);
+                u8 anchorByte = entry.signature->bytes[anchor];
+                if (scan.table.candidates[anchorByte].empty()) {
+                    scan.table.anchorBytes.push_back(anchorByte);
                 }
+                scan.table.candidates[anchorByte].push_back({ &entry, anchor });
+                longest = std::max(longest, size);
+            }
+            if (scan.table.anchorBytes.empty()) {
+                continue;
             }
-            return pat;
-        };
 
-        auto dosHeader = (PIMAGE_DOS_HEADER)module;
-        auto ntHeaders = (PIMAGE_NT_HEADERS)((u8*)module + dosHeader->e_lfanew);
+            size_t chunkCount = std::clamp<size_t>(section.size / minChunkSize, 1, threads);
+            size_t chunkSize = (section.size + chunkCount - 1) / chunkCount;
+            scan.chunks.resize(chunkCount);
+            for (size_t c = 0; c < chunkCount; ++c) {
+                ScanChunk& chunk = scan.chunks[c];
+                chunk.base = section.begin;
+                chunk.startBegin = std::min(c * chunkSize, section.size);
+                chunk.startEnd = std::min(chunk.startBegin + chunkSize, section.size);
+                chunk.end = std::min(chunk.startEnd + longest - 1, section.size);
+                chunk.hits.resize(hooks.size());
+                work.push_back({ &scan, c });
+            }
+        }
 
-        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
-        auto pattern = pattern_to_byte(signature.c_str());
-        auto scanBytes = reinterpret_cast<u8*>(module);
-
-        auto size = pattern.bytes.size();
-        auto data = pattern.bytes.data();
-        auto check = pattern.check.data();
-
-        for (auto i = 0ul; i < sizeOfImage - size; ++i) {
-            bool found = true;
-            for (auto j = 0ul; j < pattern.bytes.size(); ++j) {
-                u8 byte = pattern.bytes.data()[j];
-                if (check[j] == 1 && scanBytes[i + j] != pattern.bytes.data()[j]) {
-                    found = false;
-                    break;
+        // The calling thread works alongside at most threads - 1 workers, all pull from one queue
+        std::atomic<size_t> next = 0;
+        auto worker = [&work, &next]() {
+            for (size_t item = next.fetch_add(1); item < work.size(); item = next.fetch_add(1)) {
+                auto [scan, c] = work[item];
+                scanChunk(scan->chunks[c], scan->table);
+            }
+        };
+        std::vector<std::thread> workers;
+        size_t workerCount = std::min<size_t>(threads, work.size());
+        for (size_t w = 1; w < workerCount; ++w) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : workers) {
+            thread.join();
+        }
+
+        // Sections are in address order and chunks own disjoint, ascending start offsets so appending
+        // in order keeps hits sorted
+        for (const SectionScan& scan : scans) {
+            for (const ScanChunk& chunk : scan.chunks) {
+                for (const BatchEntry& entry : scan.entries) {
+                    auto& hits = hooks[entry.index]->hits;
+                    hits.insert(hits.end(), chunk.hits[entry.index].begin(), chunk.hits[entry.index].end());
                 }
             }
-            if (found) {
-                return reinterpret_cast<uintptr_t>(&scanBytes[i]);
+        }
+    }
+
+    bool isKnownBuild(const Utils::ModuleInfo& module)
+    {
+        return std::ranges::any_of(KnownBuilds::entries, [&](const KnownBuilds::Entry& entry) {
+            return sameBuild(entry, module);
+        });
+    }
+
+    void loadSignatureCache(const Utils::ModuleInfo& module, const std::string& path)
+    {
+        signatureCache.path = path;
+        signatureCache.entries.clear();
+
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            // <exe> <TimeDateStamp> <SizeOfImage> <CheckSum> <rva> <signature>
+            std::istringstream stream(line);
+            std::string exe, timeDateStamp, sizeOfImage, checkSum, rva;
+            if (!(stream >> exe >> timeDateStamp >> sizeOfImage >> checkSum >> rva)) {
+                continue;
+            }
+            std::string signature;
+            std::getline(stream >> std::ws, signature);
+            if (signature.empty()) {
+                continue;
             }
+            std::string identity = std::format("{} {} {} {}", exe, timeDateStamp, sizeOfImage, checkSum);
+            u32 value = static_cast<u32>(std::strtoul(rva.c_str(), nullptr, 16));
+            signatureCache.entries[identity + " " + signature] = { identity, signature, value };
         }
-        return 0;
+        LOG("Loaded {} cached signatures from {}", signatureCache.entries.size(), path);
+    }
+
+    void resolveSignatures(Utils::ModuleInfo& module, std::span<SignatureHook*> hooks, u32 threads)
+    {
+        Utils::TraceScope trace("resolveSignatures");
+        std::string identity = exeIdentity(module);
+        std::vector<SignatureHook*> misses;
+        for (SignatureHook* hook : hooks) {
+            if (hook->scanned) {
+                continue;
+            }
+            auto known = std::ranges::find_if(KnownBuilds::entries, [&](const KnownBuilds::Entry& entry) {
+                return sameBuild(entry, module) && entry.signature == hook->signature.text;
+            });
+            if (known != KnownBuilds::entries.end() && verifyAt(module, known->rva, hook->signature)) {
+                hook->hits = { reinterpret_cast<uintptr_t>(module.address) + known->rva };
+                hook->scanned = true;
+                LOG("Known '{}' @ {:s}+{:x}", hook->signature.text, module.name, known->rva);
+                continue;
+            }
+
+            auto entry = signatureCache.entries.find(identity + " " + std::string(hook->signature.text));
+            if (entry != signatureCache.entries.end() && verifyAt(module, entry->second.rva, hook->signature)) {
+                hook->hits = { reinterpret_cast<uintptr_t>(module.address) + entry->second.rva };
+                hook->scanned = true;
+                LOG("Cached '{}' @ {:s}+{:x}", hook->signature.text, module.name, entry->second.rva);
+                continue;
+            }
+            misses.push_back(hook);
+        }
+        if (misses.empty()) {
+            return;
+        }
+
+        Utils::patternScan(module.address, misses, threads);
+
+        bool dirty = false;
+        for (SignatureHook* hook : misses) {
+            // A cached RVA becomes the only hit, so the cache must not hide that the signature is not unique
+            if (hook->hits.size() != 1) {
+                continue;
+            }
+            u32 rva = static_cast<u32>(hook->hits.front() - reinterpret_cast<uintptr_t>(module.address));
+            std::string signature(hook->signature.text);
+            signatureCache.entries[identity + " " + signature] = { identity, signature, rva };
+            dirty = true;
+        }
+        if (!dirty || signatureCache.path.empty()) {
+            return;
+        }
+
+        std::ofstream file(signatureCache.path, std::ios::trunc);
+        for (auto& [key, entry] : signatureCache.entries) {
+            file << std::format("{} {:08X} {}\n", entry.identity, entry.rva, entry.signature);
+        }
+        if (!file) {
+            LOG("Failed to write signature cache {}", signatureCache.path);
+        }
+    }
+
+    uintptr_t resolveHook(Utils::ModuleInfo& module, Utils::SignatureHook& hook)
+    {
+        if (!hook.scanned) {
+            Utils::SignatureHook* hooks[] = { &hook };
+            Utils::resolveSignatures(module, hooks);
+        }
+        if (hook.hits.empty()) {
+            LOG("Did not find '{}'", hook.signature.text);
+            return 0;
+        }
+        if (hook.hits.size() > 1) {
+            LOG("Signature '{}' is not unique, {} hits, using first", hook.signature.text, hook.hits.size());
+            for (uintptr_t extra : hook.hits) {
+                LOG("    Hit @ {:s}+{:x}", module.name, extra - reinterpret_cast<u64>(module.address));
+            }
+        }
+        uintptr_t hit = hook.hits.front();
+        LOG("Found '{}' @ {:s}+{:x}", hook.signature.text, module.name, hit - reinterpret_cast<u64>(module.address));
+        return hit + static_cast<uintptr_t>(hook.offset);
     }
 }